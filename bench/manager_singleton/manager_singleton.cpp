@@ -0,0 +1,122 @@
+#include "manager_singleton.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Compares the cost of reaching a manager from many threads at once: the mutex guarded accessor the
+// singleton used to have, instance() and instance_ref().
+//
+//   bench_manager_singleton [max-threads] [calls-per-thread]
+
+namespace
+{
+class BenchManager : public UTILS::ManagerSingleton<BenchManager>
+{
+	friend class ManagerSingleton<BenchManager>;
+
+public:
+	std::string_view get_manager_name() const override
+	{
+		return "Bench Manager";
+	}
+
+	uint64_t get_value() const
+	{
+		return this->m_value;
+	}
+
+private:
+	BenchManager() = default;
+
+	void initialize() override
+	{
+		this->m_value = 1;
+	}
+
+	uint64_t m_value = 0;
+};
+
+// The accessor before call_once, a lock and a reference count update on every call.
+std::shared_ptr<BenchManager> locked_instance()
+{
+	static std::mutex					 mutex;
+	static std::shared_ptr<BenchManager> instance;
+
+	std::lock_guard<std::mutex> lock(mutex);
+	if (!instance)
+	{
+		instance = BenchManager::instance();
+	}
+	return instance;
+}
+
+template<typename Accessor>
+double measure(size_t thread_count, size_t calls, Accessor accessor)
+{
+	std::barrier			 start(static_cast<std::ptrdiff_t>(thread_count + 1));
+	std::vector<std::thread> threads;
+	std::atomic<uint64_t>	 total = 0;
+
+	for (size_t i = 0; i < thread_count; ++i)
+	{
+		threads.emplace_back([&] {
+			uint64_t sum = 0;
+			start.arrive_and_wait();
+
+			for (size_t call = 0; call < calls; ++call)
+			{
+				sum += accessor();
+			}
+
+			total += sum;
+		});
+	}
+
+	// The threads are released by the barrier, so the clock has to start before it.
+	auto started = std::chrono::steady_clock::now();
+	start.arrive_and_wait();
+
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+
+	auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - started);
+
+	if (total != thread_count * calls)
+	{
+		fmt::print(stderr, "Unexpected result {}\n", total.load());
+	}
+
+	// Wall time per call of a single thread, it stays flat as long as the threads do not contend.
+	return elapsed.count() / static_cast<double>(calls);
+}
+} // anonymous namespace
+
+int main(const int argc, const char** argv)
+{
+	size_t max_threads = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : std::max(std::thread::hardware_concurrency(), 1U);
+	size_t calls	   = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1000000;
+
+	BenchManager::instance_ref();
+
+	fmt::print("{:>8} {:>16} {:>16} {:>16}\n", "threads", "locked ns/call", "instance ns/call", "ref ns/call");
+
+	for (size_t thread_count = 1; thread_count <= max_threads; thread_count *= 2)
+	{
+		double locked	= measure(thread_count, calls, [] { return locked_instance()->get_value(); });
+		double instance = measure(thread_count, calls, [] { return BenchManager::instance()->get_value(); });
+		double ref		= measure(thread_count, calls, [] { return BenchManager::instance_ref().get_value(); });
+
+		fmt::print("{:>8} {:>16.2f} {:>16.2f} {:>16.2f}\n", thread_count, locked, instance, ref);
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,122 @@
+#include "network_manager.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// Sends the same burst of small POSTs one after another and through NetworkManager::submit_batch. Needs
+// a server on the loopback interface, nghttpd stands in for an HTTP/2 endpoint:
+//
+//   openssl req -x509 -newkey rsa:2048 -nodes -days 1 -subj /CN=localhost -keyout key.pem -out cert.pem
+//   echo ok > ok.txt && nghttpd --htdocs=. 8443 key.pem cert.pem
+//   bench_network_batch https://localhost:8443/ok.txt cert.pem 64 20
+//
+// An http:// URL, with "-" as the certificate, measures the HTTP/1.1 fallback instead. nghttpd answers
+// immediately, putting nghttpx in front of a slower backend shows the effect of server latency.
+
+namespace
+{
+struct BenchResult
+{
+	std::chrono::microseconds elapsed	  = {};
+	size_t					  succeeded	  = 0;
+	size_t					  connections = 0;
+};
+
+void add_responses(BenchResult& result, const std::vector<UTILS::NetworkResponse>& responses)
+{
+	for (const auto& response : responses)
+	{
+		result.succeeded += response.http_code >= 200 && response.http_code < 300 ? 1 : 0;
+		result.connections += response.timing.connection_reused ? 0 : 1;
+	}
+}
+
+BenchResult run_serialized(UTILS::NetworkManager& network_manager, const std::vector<UTILS::NetworkRequest>& requests, size_t rounds)
+{
+	BenchResult result;
+	auto		started = std::chrono::steady_clock::now();
+
+	for (size_t round = 0; round < rounds; ++round)
+	{
+		std::vector<UTILS::NetworkResponse> responses;
+		responses.reserve(requests.size());
+
+		for (const auto& request : requests)
+		{
+			responses.push_back(network_manager.make_request(request));
+		}
+
+		add_responses(result, responses);
+	}
+
+	result.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started);
+	return result;
+}
+
+BenchResult run_batched(UTILS::NetworkManager& network_manager, const std::vector<UTILS::NetworkRequest>& requests, size_t rounds)
+{
+	BenchResult result;
+	auto		started = std::chrono::steady_clock::now();
+
+	for (size_t round = 0; round < rounds; ++round)
+	{
+		add_responses(result, network_manager.submit_batch(requests));
+	}
+
+	result.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started);
+	return result;
+}
+
+void print_result(std::string_view name, const BenchResult& result, size_t total)
+{
+	double seconds = std::chrono::duration<double>(result.elapsed).count();
+
+	fmt::print("{:<12} {:>8} requests in {:>9.3f} ms, {:>10.0f} requests/s, {} succeeded, {} connections opened\n",
+			   name,
+			   total,
+			   seconds * 1000.0,
+			   static_cast<double>(total) / seconds,
+			   result.succeeded,
+			   result.connections);
+}
+} // anonymous namespace
+
+int main(const int argc, const char** argv)
+{
+	if (argc < 2)
+	{
+		fmt::print(stderr, "Usage: {} <url> [ca-file|-] [batch-size] [rounds]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	std::string ca_file	   = argc > 2 && std::string_view(argv[2]) != "-" ? argv[2] : "";
+	size_t		batch_size = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 64;
+	size_t		rounds	   = argc > 4 ? std::strtoull(argv[4], nullptr, 10) : 20;
+
+	// Shaped like a notification, a small POST to one endpoint.
+	UTILS::NetworkRequest request;
+	request.url		= argv[1];
+	request.method	= UTILS::HttpMethod::POST;
+	request.body	= "benchmark";
+	request.ca_file = ca_file;
+
+	std::vector<UTILS::NetworkRequest> requests(batch_size, request);
+	auto&							   network_manager = UTILS::NetworkManager::instance_ref();
+
+	// Both modes start with an established connection.
+	network_manager.make_request(request);
+
+	auto serialized = run_serialized(network_manager, requests, rounds);
+	auto batched	= run_batched(network_manager, requests, rounds);
+
+	print_result("serialized", serialized, batch_size * rounds);
+	print_result("batched", batched, batch_size * rounds);
+	fmt::print("speedup      {:.2f}x\n",
+			   std::chrono::duration<double>(serialized.elapsed).count() / std::chrono::duration<double>(batched.elapsed).count());
+
+	network_manager.shutdown();
+
+	return EXIT_SUCCESS;
+}
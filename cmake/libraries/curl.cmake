@@ -5,6 +5,15 @@ FetchContent_Declare(
     GIT_REPOSITORY https://github.com/curl/curl.git
     GIT_TAG        curl-8_15_0
 )
+
+# Content decoding is built against the fetched zlib and zstd, so CURLOPT_ACCEPT_ENCODING does not
+# depend on the host. Brotli is not fetched and stays disabled.
+set(CURL_ZLIB                 ON  CACHE STRING "" FORCE)
+set(CURL_ZSTD                 ON  CACHE STRING "" FORCE)
+set(CURL_BROTLI               OFF CACHE STRING "" FORCE)
+set(CURL_USE_PKGCONFIG        OFF CACHE BOOL   "" FORCE)
+set(CURL_ENABLE_EXPORT_TARGET OFF CACHE BOOL   "" FORCE)
+
 FetchContent_MakeAvailable(${CURRENT_LIBRARY_NAME})
 
 list(APPEND PROJECT_LIBRARIES_LIST CURL::libcurl)
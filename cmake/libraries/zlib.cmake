@@ -0,0 +1,20 @@
+set(CURRENT_LIBRARY_NAME zlib)
+
+FetchContent_Declare(
+    ${CURRENT_LIBRARY_NAME}
+    GIT_REPOSITORY https://github.com/madler/zlib.git
+    GIT_TAG        v1.3.1
+)
+FetchContent_MakeAvailable(${CURRENT_LIBRARY_NAME})
+
+# zlib generates zconf.h into its binary directory, so consumers need both include paths.
+target_include_directories(zlibstatic INTERFACE
+    ${zlib_SOURCE_DIR}
+    ${zlib_BINARY_DIR}
+)
+list(APPEND PROJECT_LIBRARIES_LIST zlibstatic)
+
+# Lets find_package(ZLIB) in curl pick up this build instead of whatever the host provides.
+add_library(ZLIB::ZLIB ALIAS zlibstatic)
+set(ZLIB_INCLUDE_DIR ${zlib_SOURCE_DIR} CACHE PATH "" FORCE)
+set(ZLIB_LIBRARY zlibstatic CACHE STRING "" FORCE)
@@ -0,0 +1,19 @@
+set(CURRENT_LIBRARY_NAME zstd)
+
+FetchContent_Declare(
+    ${CURRENT_LIBRARY_NAME}
+    GIT_REPOSITORY https://github.com/facebook/zstd.git
+    GIT_TAG        v1.5.7
+    SOURCE_SUBDIR  build/cmake
+)
+
+set(ZSTD_BUILD_PROGRAMS OFF CACHE BOOL "" FORCE)
+set(ZSTD_BUILD_TESTS    OFF CACHE BOOL "" FORCE)
+set(ZSTD_BUILD_SHARED   OFF CACHE BOOL "" FORCE)
+set(ZSTD_BUILD_STATIC   ON  CACHE BOOL "" FORCE)
+
+FetchContent_MakeAvailable(${CURRENT_LIBRARY_NAME})
+
+# Only curl decodes zstd, it finds this build through the variables its FindZstd module checks first.
+set(ZSTD_INCLUDE_DIR ${zstd_SOURCE_DIR}/lib CACHE PATH "" FORCE)
+set(ZSTD_LIBRARY libzstd_static CACHE STRING "" FORCE)
@@ -32,6 +32,8 @@ set(PROJECT_DIRECTORIES_LIST)
 # [LIBRARIES]
 include(cmake/libraries/lmdb.cmake)
 include(cmake/libraries/lmdbxx.cmake)
+include(cmake/libraries/zlib.cmake)
+include(cmake/libraries/zstd.cmake)
 include(cmake/libraries/curl.cmake)
 include(cmake/libraries/fmt.cmake)
 include(cmake/libraries/spdlog.cmake)
@@ -66,4 +68,12 @@ endif()
 # [SOURCE GROUPS]
 source_group("Main" FILES ${PROJECT_MAIN_SRC_FILES})
 
+if(PROJECT_BUILD_TESTS)
+    include(cmake/utils/tests.cmake)
+endif()
+
+if(PROJECT_BUILD_BENCHMARKS)
+    include(cmake/utils/benchmarks.cmake)
+endif()
+
 include(cmake/utils/postbuild_scripts.cmake)
@@ -0,0 +1,20 @@
+# Every bench/<name>/<name>.cpp becomes a bench_<name> executable linked against the project libraries.
+set(PROJECT_BENCH_DIR "${CMAKE_SOURCE_DIR}/bench")
+
+file(GLOB PROJECT_BENCH_SRC_FILES CONFIGURE_DEPENDS
+    "${PROJECT_BENCH_DIR}/*/*.cpp"
+)
+
+foreach(BENCH_SRC_FILE ${PROJECT_BENCH_SRC_FILES})
+    get_filename_component(BENCH_NAME ${BENCH_SRC_FILE} NAME_WE)
+    set(BENCH_TARGET_NAME "bench_${BENCH_NAME}")
+
+    add_executable(${BENCH_TARGET_NAME} ${BENCH_SRC_FILE})
+
+    target_include_directories(${BENCH_TARGET_NAME} PRIVATE ${PROJECT_INCLUDE_DIRS})
+    target_include_directories(${BENCH_TARGET_NAME} PRIVATE ${PROJECT_DIRECTORIES_LIST})
+    target_link_directories(${BENCH_TARGET_NAME}    PRIVATE ${PROJECT_INCLUDE_DIRS})
+    target_link_libraries(${BENCH_TARGET_NAME}      PRIVATE ${PROJECT_LIBRARIES_LIST})
+
+    source_group("Benchmarks" FILES ${BENCH_SRC_FILE})
+endforeach()
@@ -0,0 +1,29 @@
+# Every tests/<name>/<name>.cpp becomes a test_<name> executable registered with CTest. Tests run with
+# their own HOME, so the managers they create never touch the settings of the user running them.
+set(PROJECT_TESTS_DIR "${CMAKE_SOURCE_DIR}/tests")
+
+enable_testing()
+
+file(GLOB PROJECT_TESTS_SRC_FILES CONFIGURE_DEPENDS
+    "${PROJECT_TESTS_DIR}/*/*.cpp"
+)
+
+foreach(TEST_SRC_FILE ${PROJECT_TESTS_SRC_FILES})
+    get_filename_component(TEST_NAME ${TEST_SRC_FILE} NAME_WE)
+    set(TEST_TARGET_NAME "test_${TEST_NAME}")
+    set(TEST_HOME_DIR    "${CMAKE_CURRENT_BINARY_DIR}/tests/${TEST_NAME}")
+
+    add_executable(${TEST_TARGET_NAME} ${TEST_SRC_FILE})
+
+    target_include_directories(${TEST_TARGET_NAME} PRIVATE ${PROJECT_INCLUDE_DIRS})
+    target_include_directories(${TEST_TARGET_NAME} PRIVATE ${PROJECT_DIRECTORIES_LIST})
+    target_link_directories(${TEST_TARGET_NAME}    PRIVATE ${PROJECT_INCLUDE_DIRS})
+    target_link_libraries(${TEST_TARGET_NAME}      PRIVATE ${PROJECT_LIBRARIES_LIST})
+
+    file(MAKE_DIRECTORY ${TEST_HOME_DIR})
+
+    add_test(NAME ${TEST_NAME} COMMAND ${TEST_TARGET_NAME} WORKING_DIRECTORY ${TEST_HOME_DIR})
+    set_tests_properties(${TEST_NAME} PROPERTIES ENVIRONMENT "HOME=${TEST_HOME_DIR};XDG_CONFIG_HOME=${TEST_HOME_DIR}")
+
+    source_group("Tests" FILES ${TEST_SRC_FILE})
+endforeach()
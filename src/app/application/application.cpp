@@ -1,5 +1,7 @@
 #include "application.hpp"
 
+#include "network_manager.hpp"
+
 #include <chrono>
 #include <iomanip>
 #include <lmdb++.h>
@@ -91,15 +93,42 @@ int Application::run()
 
 bool Application::initialize_managers(const int argc, const char** argv)
 {
-	this->m_option_manager		 = UTILS::OptionManager::instance();
-	this->m_settings_manager	 = UTILS::SettingsManager::instance();
-	this->m_notification_manager = UTILS::NotificationManager::instance();
+	// Options are parsed and the --set overrides applied before the managers that read settings on initialization exist.
+	this->m_manager_registry.add_manager<UTILS::OptionManager>();
+	this->m_manager_registry.add_manager<UTILS::SettingsManager>();
+
+	// Falling back to lazy creation would initialize the failed managers again outside the registry.
+	if (!this->m_manager_registry.initialize_managers())
+	{
+		SPD_ERROR_CLASS(COMMON::d_settings_group_application, "Unable to initialize the option and settings managers.");
+		return false;
+	}
+
+	this->m_option_manager	 = UTILS::OptionManager::instance();
+	this->m_settings_manager = UTILS::SettingsManager::instance();
 
 	this->m_option_manager->add_option("h,help", "Prints help menu.");
 	this->m_option_manager->add_option("d,debug", "Prints debug info.");
+	this->m_option_manager->add_option<std::vector<std::string>>("set", "Overrides a setting for this run, e.g. --set notifications.workers=4.");
 
 	this->m_option_manager->parse_options(argc, argv);
 
+	if (this->m_option_manager->has_option("set"))
+	{
+		this->m_settings_manager->set_command_line_overrides(this->m_option_manager->get_option_values("set"));
+	}
+
+	// Dependencies such as the network manager are registered by the managers that declare them.
+	this->m_manager_registry.add_manager<UTILS::NotificationManager>();
+
+	if (!this->m_manager_registry.initialize_managers())
+	{
+		SPD_ERROR_CLASS(COMMON::d_settings_group_application, "Unable to initialize the notification manager.");
+		return false;
+	}
+
+	this->m_notification_manager = UTILS::NotificationManager::instance();
+
 	if (this->m_option_manager->has_option("h"))
 	{
 		this->m_option_manager->log_help();
@@ -137,7 +166,7 @@ bool Application::initialize_app()
 
 void Application::cleanup()
 {
-	this->m_notification_manager->shutdown();
+	this->m_manager_registry.shutdown_managers();
 
 	SPD_INFO_CLASS(COMMON::d_settings_group_application, "Application cleaned up");
 }
@@ -1,6 +1,7 @@
 #ifndef APPLICATION_HPP
 #define APPLICATION_HPP
 
+#include "manager_registry.hpp"
 #include "notification_manager.hpp"
 #include "option_manager.hpp"
 #include "settings_manager.hpp"
@@ -25,6 +26,8 @@ private:
 	void cleanup();
 
 private:
+	UTILS::ManagerRegistry m_manager_registry;
+
 	std::shared_ptr<UTILS::NotificationManager> m_notification_manager;
 	std::shared_ptr<UTILS::SettingsManager>		m_settings_manager;
 	std::shared_ptr<UTILS::OptionManager>		m_option_manager;
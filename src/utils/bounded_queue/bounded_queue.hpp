@@ -0,0 +1,126 @@
+#ifndef BOUNDED_QUEUE_HPP
+#define BOUNDED_QUEUE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <utility>
+
+namespace UTILS
+{
+// Lock-free bounded ring buffer for any number of producers and consumers. Each cell carries a
+// sequence number telling producers and consumers whose turn it is, so a slot is never shared.
+template<typename T>
+class BoundedQueue
+{
+public:
+	explicit BoundedQueue(size_t capacity) :
+		m_capacity(std::bit_ceil(std::max<size_t>(capacity, 2))),
+		m_cells(std::make_unique<Cell[]>(m_capacity))
+	{
+		for (size_t i = 0; i < this->m_capacity; ++i)
+		{
+			this->m_cells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	BoundedQueue(const BoundedQueue&)			 = delete;
+	BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+	// The value is only moved from when it was queued.
+	bool try_push(T&& value)
+	{
+		size_t position = this->m_enqueue_position.load(std::memory_order_relaxed);
+
+		for (;;)
+		{
+			Cell&	  cell	   = this->m_cells[position & (this->m_capacity - 1)];
+			size_t	  sequence = cell.sequence.load(std::memory_order_acquire);
+			ptrdiff_t distance = static_cast<ptrdiff_t>(sequence) - static_cast<ptrdiff_t>(position);
+
+			if (distance == 0)
+			{
+				if (this->m_enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				{
+					cell.value.emplace(std::move(value));
+					cell.sequence.store(position + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (distance < 0)
+			{
+				return false;
+			}
+			else
+			{
+				position = this->m_enqueue_position.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	bool try_pop(T& value)
+	{
+		size_t position = this->m_dequeue_position.load(std::memory_order_relaxed);
+
+		for (;;)
+		{
+			Cell&	  cell	   = this->m_cells[position & (this->m_capacity - 1)];
+			size_t	  sequence = cell.sequence.load(std::memory_order_acquire);
+			ptrdiff_t distance = static_cast<ptrdiff_t>(sequence) - static_cast<ptrdiff_t>(position + 1);
+
+			if (distance == 0)
+			{
+				if (this->m_dequeue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				{
+					value = std::move(*cell.value);
+					cell.value.reset();
+					cell.sequence.store(position + this->m_capacity, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (distance < 0)
+			{
+				return false;
+			}
+			else
+			{
+				position = this->m_dequeue_position.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	// Approximate while producers or consumers are active.
+	size_t size() const
+	{
+		size_t enqueued = this->m_enqueue_position.load(std::memory_order_relaxed);
+		size_t dequeued = this->m_dequeue_position.load(std::memory_order_relaxed);
+		return enqueued > dequeued ? std::min(enqueued - dequeued, this->m_capacity) : 0;
+	}
+
+	size_t capacity() const
+	{
+		return this->m_capacity;
+	}
+
+private:
+	struct Cell
+	{
+		std::atomic<size_t> sequence;
+		std::optional<T>	value;
+	};
+
+	static constexpr size_t CACHE_LINE_SIZE = 64;
+
+private:
+	const size_t			m_capacity;
+	std::unique_ptr<Cell[]> m_cells;
+
+	alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_enqueue_position = 0;
+	alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_dequeue_position = 0;
+};
+} // namespace UTILS
+
+#endif // BOUNDED_QUEUE_HPP
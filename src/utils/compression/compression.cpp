@@ -0,0 +1,59 @@
+#include "compression.hpp"
+
+#include "spdlog_wrapper.hpp"
+
+#include <zlib.h>
+
+namespace
+{
+constexpr int GZIP_WINDOW_BITS = 15 + 16;
+
+double ratio(uint64_t original, uint64_t encoded)
+{
+	return encoded ? static_cast<double>(original) / static_cast<double>(encoded) : 1.0;
+}
+} // anonymous namespace
+
+namespace UTILS
+{
+double CompressionStats::request_ratio() const
+{
+	return ratio(this->request_bytes, this->request_bytes_encoded);
+}
+
+double CompressionStats::response_ratio() const
+{
+	return ratio(this->response_bytes, this->response_bytes_encoded);
+}
+
+bool gzip_compress(std::span<const std::byte> input, std::string& output, int level)
+{
+	z_stream stream {};
+
+	if (deflateInit2(&stream, level, Z_DEFLATED, GZIP_WINDOW_BITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+	{
+		SPD_ERROR_CLASS(COMMON::d_settings_group_utils, "Failed to initialize gzip compressor.");
+		return false;
+	}
+
+	output.resize(deflateBound(&stream, static_cast<uLong>(input.size())));
+
+	stream.next_in	 = reinterpret_cast<Bytef*>(const_cast<std::byte*>(input.data()));
+	stream.avail_in	 = static_cast<uInt>(input.size());
+	stream.next_out	 = reinterpret_cast<Bytef*>(output.data());
+	stream.avail_out = static_cast<uInt>(output.size());
+
+	int result = deflate(&stream, Z_FINISH);
+	output.resize(stream.total_out);
+	deflateEnd(&stream);
+
+	if (result != Z_STREAM_END)
+	{
+		SPD_ERROR_CLASS(COMMON::d_settings_group_utils, fmt::format("gzip compression failed with code {}", result));
+		output.clear();
+		return false;
+	}
+
+	return true;
+}
+} // namespace UTILS
@@ -0,0 +1,27 @@
+#ifndef COMPRESSION_HPP
+#define COMPRESSION_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+namespace UTILS
+{
+struct CompressionStats
+{
+	uint64_t				  request_bytes			 = 0;
+	uint64_t				  request_bytes_encoded	 = 0;
+	uint64_t				  response_bytes		 = 0;
+	uint64_t				  response_bytes_encoded = 0;
+	std::chrono::microseconds compression_time		 = {};
+
+	double request_ratio() const;
+	double response_ratio() const;
+};
+
+bool gzip_compress(std::span<const std::byte> input, std::string& output, int level = 6);
+} // namespace UTILS
+
+#endif // COMPRESSION_HPP
@@ -0,0 +1,208 @@
+#include "connection_pool.hpp"
+
+#include "spdlog_wrapper.hpp"
+
+namespace UTILS
+{
+ConnectionPool::~ConnectionPool()
+{
+	this->cleanup();
+}
+
+bool ConnectionPool::initialize(const ConnectionPoolOptions& options)
+{
+	std::lock_guard<std::mutex> lock(this->m_pool_mutex);
+
+	this->m_options = options;
+	this->m_share.reset(curl_share_init());
+
+	if (!this->m_share)
+	{
+		SPD_ERROR_CLASS(COMMON::d_settings_group_utils, "Failed to initialize CURL share handle.");
+		return false;
+	}
+
+	curl_share_setopt(this->m_share.get(), CURLSHOPT_LOCKFUNC, lock_callback);
+	curl_share_setopt(this->m_share.get(), CURLSHOPT_UNLOCKFUNC, unlock_callback);
+	curl_share_setopt(this->m_share.get(), CURLSHOPT_USERDATA, this);
+	curl_share_setopt(this->m_share.get(), CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+	curl_share_setopt(this->m_share.get(), CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+
+	return true;
+}
+
+void ConnectionPool::cleanup()
+{
+	std::lock_guard<std::mutex> lock(this->m_pool_mutex);
+
+	this->m_idle_handles.clear();
+	this->m_share.reset();
+}
+
+void ConnectionPool::set_options(const ConnectionPoolOptions& options)
+{
+	std::lock_guard<std::mutex> lock(this->m_pool_mutex);
+	this->m_options = options;
+}
+
+ConnectionPoolOptions ConnectionPool::get_options() const
+{
+	std::lock_guard<std::mutex> lock(this->m_pool_mutex);
+	return this->m_options;
+}
+
+CurlHandle ConnectionPool::acquire(std::string_view host)
+{
+	std::lock_guard<std::mutex> lock(this->m_pool_mutex);
+
+	this->evict_idle(std::chrono::steady_clock::now());
+
+	auto iterator = this->m_idle_handles.find(std::string(host));
+
+	if (iterator != this->m_idle_handles.end() && !iterator->second.empty())
+	{
+		CurlHandle curl = std::move(iterator->second.back().curl);
+		iterator->second.pop_back();
+
+		this->configure_handle(curl.get());
+		++this->m_hits;
+
+		return curl;
+	}
+
+	CurlHandle curl(curl_easy_init());
+
+	if (curl)
+	{
+		this->configure_handle(curl.get());
+		++this->m_misses;
+	}
+
+	return curl;
+}
+
+void ConnectionPool::release(std::string_view host, CurlHandle curl)
+{
+	if (!curl)
+	{
+		return;
+	}
+
+	curl_easy_reset(curl.get());
+
+	std::lock_guard<std::mutex> lock(this->m_pool_mutex);
+
+	if (!this->m_share)
+	{
+		return;
+	}
+
+	auto  now	  = std::chrono::steady_clock::now();
+	auto& handles = this->m_idle_handles[std::string(host)];
+
+	if (handles.size() >= this->m_options.max_idle_handles_per_host)
+	{
+		handles.erase(handles.begin());
+		++this->m_evictions;
+	}
+
+	handles.push_back({std::move(curl), now});
+
+	this->evict_idle(now);
+}
+
+void ConnectionPool::record_connection(CURL* curl)
+{
+	long new_connections = 0;
+	curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &new_connections);
+
+	if (new_connections > 0)
+	{
+		this->m_new_connections += static_cast<uint64_t>(new_connections);
+	}
+	else
+	{
+		++this->m_reused_connections;
+	}
+}
+
+ConnectionPoolStats ConnectionPool::get_stats() const
+{
+	ConnectionPoolStats stats;
+	stats.hits				 = this->m_hits;
+	stats.misses			 = this->m_misses;
+	stats.evictions			 = this->m_evictions;
+	stats.reused_connections = this->m_reused_connections;
+	stats.new_connections	 = this->m_new_connections;
+	return stats;
+}
+
+std::string ConnectionPool::extract_host(const std::string& url)
+{
+	std::string host;
+	CURLU*		handle = curl_url();
+
+	if (!handle)
+	{
+		return host;
+	}
+
+	char* part = nullptr;
+
+	if (curl_url_set(handle, CURLUPART_URL, url.c_str(), CURLU_GUESS_SCHEME) == CURLUE_OK)
+	{
+		if (curl_url_get(handle, CURLUPART_HOST, &part, 0) == CURLUE_OK)
+		{
+			host = part;
+			curl_free(part);
+		}
+		if (curl_url_get(handle, CURLUPART_PORT, &part, CURLU_DEFAULT_PORT) == CURLUE_OK)
+		{
+			host += fmt::format(":{}", part);
+			curl_free(part);
+		}
+	}
+
+	curl_url_cleanup(handle);
+	return host;
+}
+
+void ConnectionPool::lock_callback(CURL* /*curl*/, curl_lock_data data, curl_lock_access /*access*/, void* userp)
+{
+	static_cast<ConnectionPool*>(userp)->m_share_mutexes[data].lock();
+}
+
+void ConnectionPool::unlock_callback(CURL* /*curl*/, curl_lock_data data, void* userp)
+{
+	static_cast<ConnectionPool*>(userp)->m_share_mutexes[data].unlock();
+}
+
+void ConnectionPool::configure_handle(CURL* curl) const
+{
+	curl_easy_setopt(curl, CURLOPT_SHARE, this->m_share.get());
+	curl_easy_setopt(curl, CURLOPT_MAXAGE_CONN, static_cast<long>(this->m_options.idle_timeout.count()));
+	curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+}
+
+void ConnectionPool::evict_idle(std::chrono::steady_clock::time_point now)
+{
+	for (auto iterator = this->m_idle_handles.begin(); iterator != this->m_idle_handles.end();)
+	{
+		auto& handles = iterator->second;
+
+		auto expired = std::erase_if(handles, [&](const IdleHandle& handle) {
+			return now - handle.released_at > this->m_options.idle_timeout;
+		});
+		this->m_evictions += expired;
+
+		if (handles.empty())
+		{
+			iterator = this->m_idle_handles.erase(iterator);
+		}
+		else
+		{
+			++iterator;
+		}
+	}
+}
+} // namespace UTILS
@@ -0,0 +1,112 @@
+#ifndef CONNECTION_POOL_HPP
+#define CONNECTION_POOL_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <curl/curl.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace UTILS
+{
+struct CurlDeleter
+{
+	void operator()(CURL* curl)
+	{
+		if (curl)
+		{
+			curl_easy_cleanup(curl);
+		}
+	}
+};
+
+struct CurlShareDeleter
+{
+	void operator()(CURLSH* share)
+	{
+		if (share)
+		{
+			curl_share_cleanup(share);
+		}
+	}
+};
+
+using CurlHandle = std::unique_ptr<CURL, CurlDeleter>;
+
+struct ConnectionPoolOptions
+{
+	long				 max_connections_per_host  = 8L;
+	long				 max_total_connections	   = 64L;
+	size_t				 max_idle_handles_per_host = 8;
+	std::chrono::seconds idle_timeout			   = std::chrono::seconds(60);
+};
+
+struct ConnectionPoolStats
+{
+	uint64_t hits				= 0;
+	uint64_t misses				= 0;
+	uint64_t evictions			= 0;
+	uint64_t reused_connections	= 0;
+	uint64_t new_connections	= 0;
+};
+
+class ConnectionPool
+{
+public:
+	ConnectionPool() = default;
+	~ConnectionPool();
+
+	ConnectionPool(const ConnectionPool&)			 = delete;
+	ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+	bool initialize(const ConnectionPoolOptions& options = {});
+	void cleanup();
+
+	void				  set_options(const ConnectionPoolOptions& options);
+	ConnectionPoolOptions get_options() const;
+
+	CurlHandle acquire(std::string_view host);
+	void	   release(std::string_view host, CurlHandle curl);
+
+	void				record_connection(CURL* curl);
+	ConnectionPoolStats get_stats() const;
+
+	static std::string extract_host(const std::string& url);
+
+private:
+	struct IdleHandle
+	{
+		CurlHandle							  curl;
+		std::chrono::steady_clock::time_point released_at;
+	};
+
+	static void lock_callback(CURL* curl, curl_lock_data data, curl_lock_access access, void* userp);
+	static void unlock_callback(CURL* curl, curl_lock_data data, void* userp);
+
+	void configure_handle(CURL* curl) const;
+	void evict_idle(std::chrono::steady_clock::time_point now);
+
+private:
+	std::unique_ptr<CURLSH, CurlShareDeleter>				 m_share;
+	std::array<std::mutex, CURL_LOCK_DATA_LAST>				 m_share_mutexes;
+	std::unordered_map<std::string, std::vector<IdleHandle>> m_idle_handles;
+	ConnectionPoolOptions									 m_options;
+
+	std::atomic<uint64_t> m_hits			   = 0;
+	std::atomic<uint64_t> m_misses			   = 0;
+	std::atomic<uint64_t> m_evictions		   = 0;
+	std::atomic<uint64_t> m_reused_connections = 0;
+	std::atomic<uint64_t> m_new_connections	   = 0;
+
+protected:
+	mutable std::mutex m_pool_mutex;
+};
+} // namespace UTILS
+
+#endif // CONNECTION_POOL_HPP
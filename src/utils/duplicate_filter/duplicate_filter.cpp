@@ -0,0 +1,39 @@
+#include "duplicate_filter.hpp"
+
+#include <algorithm>
+
+namespace UTILS
+{
+DuplicateFilter::DuplicateFilter(std::chrono::milliseconds window, size_t shard_count) :
+	m_window(window),
+	m_shard_count(std::max<size_t>(shard_count, 1)),
+	m_shards(std::make_unique<Shard[]>(m_shard_count))
+{}
+
+bool DuplicateFilter::is_duplicate(uint64_t hash, std::chrono::steady_clock::time_point now)
+{
+	Shard& shard = this->m_shards[hash % this->m_shard_count];
+
+	std::lock_guard<std::mutex> lock(shard.mutex);
+
+	if (now >= shard.next_prune)
+	{
+		std::erase_if(shard.seen, [&](const auto& entry) { return now - entry.second >= this->m_window; });
+		shard.next_prune = now + this->m_window;
+	}
+
+	auto [iterator, inserted] = shard.seen.try_emplace(hash, now);
+	if (inserted)
+	{
+		return false;
+	}
+
+	if (now - iterator->second >= this->m_window)
+	{
+		iterator->second = now;
+		return false;
+	}
+
+	return true;
+}
+} // namespace UTILS
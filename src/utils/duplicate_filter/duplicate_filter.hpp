@@ -0,0 +1,43 @@
+#ifndef DUPLICATE_FILTER_HPP
+#define DUPLICATE_FILTER_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace UTILS
+{
+// Remembers content hashes for a time window. A hash is let through once and then reported as a
+// duplicate until the window since it was let through has passed. Hashes are spread over
+// independently locked shards, each pruned of expired entries as it is used.
+class DuplicateFilter
+{
+public:
+	explicit DuplicateFilter(std::chrono::milliseconds window, size_t shard_count = 16);
+
+	DuplicateFilter(const DuplicateFilter&)			   = delete;
+	DuplicateFilter& operator=(const DuplicateFilter&) = delete;
+
+	bool is_duplicate(uint64_t hash, std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
+
+private:
+	static constexpr size_t CACHE_LINE_SIZE = 64;
+
+	struct alignas(CACHE_LINE_SIZE) Shard
+	{
+		std::mutex															mutex;
+		std::unordered_map<uint64_t, std::chrono::steady_clock::time_point>	seen;
+		std::chrono::steady_clock::time_point								next_prune;
+	};
+
+private:
+	std::chrono::milliseconds m_window;
+	size_t					  m_shard_count;
+	std::unique_ptr<Shard[]>  m_shards;
+};
+} // namespace UTILS
+
+#endif // DUPLICATE_FILTER_HPP
@@ -0,0 +1,140 @@
+#include "file_watcher.hpp"
+
+#include "spdlog_wrapper.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <optional>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace UTILS
+{
+FileWatcher::~FileWatcher()
+{
+	this->stop();
+}
+
+bool FileWatcher::start(const fs::path& file_path, std::chrono::milliseconds debounce, ChangeCallback on_change)
+{
+	this->stop();
+
+#if defined(__linux__)
+	auto directory = file_path.has_parent_path() ? file_path.parent_path() : fs::current_path();
+
+	this->m_inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	this->m_wakeup_fd  = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+	if (this->m_inotify_fd < 0 || this->m_wakeup_fd < 0 ||
+		inotify_add_watch(this->m_inotify_fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) < 0)
+	{
+		SPD_ERROR_CLASS(COMMON::d_settings_group_utils, fmt::format("Unable to watch {} for changes.", file_path.string()));
+		this->stop();
+		return false;
+	}
+
+	this->m_file_name = file_path.filename();
+	this->m_debounce  = debounce;
+	this->m_on_change = std::move(on_change);
+	this->m_running	  = true;
+	this->m_thread	  = std::thread(&FileWatcher::run, this);
+
+	return true;
+#else
+	SPD_WARN_CLASS(COMMON::d_settings_group_utils, fmt::format("Watching {} for changes is not supported on this platform.", file_path.string()));
+	return false;
+#endif
+}
+
+void FileWatcher::stop()
+{
+#if defined(__linux__)
+	if (this->m_running.exchange(false))
+	{
+		uint64_t value = 1;
+		[[maybe_unused]] auto written = write(this->m_wakeup_fd, &value, sizeof(value));
+	}
+
+	if (this->m_thread.joinable())
+	{
+		this->m_thread.join();
+	}
+
+	if (this->m_inotify_fd >= 0)
+	{
+		close(this->m_inotify_fd);
+		this->m_inotify_fd = -1;
+	}
+	if (this->m_wakeup_fd >= 0)
+	{
+		close(this->m_wakeup_fd);
+		this->m_wakeup_fd = -1;
+	}
+#endif
+}
+
+bool FileWatcher::is_running() const
+{
+	return this->m_running;
+}
+
+void FileWatcher::run()
+{
+#if defined(__linux__)
+	std::array<pollfd, 2> descriptors = {pollfd {this->m_inotify_fd, POLLIN, 0}, pollfd {this->m_wakeup_fd, POLLIN, 0}};
+	alignas(inotify_event) std::array<char, 4096> buffer;
+
+	std::optional<std::chrono::steady_clock::time_point> deadline;
+
+	while (this->m_running)
+	{
+		int timeout = -1;
+		if (deadline)
+		{
+			auto remaining = std::chrono::ceil<std::chrono::milliseconds>(*deadline - std::chrono::steady_clock::now());
+			timeout		   = static_cast<int>(std::max<int64_t>(remaining.count(), 0));
+		}
+
+		int ready = poll(descriptors.data(), descriptors.size(), timeout);
+
+		if (ready < 0 && errno != EINTR)
+		{
+			SPD_ERROR_CLASS(COMMON::d_settings_group_utils, "File watcher stopped, polling failed.");
+			return;
+		}
+
+		if (ready > 0 && (descriptors[0].revents & POLLIN))
+		{
+			ssize_t length;
+			while ((length = read(this->m_inotify_fd, buffer.data(), buffer.size())) > 0)
+			{
+				for (ssize_t offset = 0; offset < length;)
+				{
+					const auto* event = reinterpret_cast<const inotify_event*>(buffer.data() + offset);
+					offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+					if (event->len > 0 && this->m_file_name == event->name)
+					{
+						// Every write restarts the quiet period, so a burst of saves is reported once.
+						deadline = std::chrono::steady_clock::now() + this->m_debounce;
+					}
+				}
+			}
+		}
+
+		// Checked after events too, unrelated activity in the directory must not hold back a due reload.
+		if (deadline && std::chrono::steady_clock::now() >= *deadline && this->m_running)
+		{
+			deadline.reset();
+			this->m_on_change();
+		}
+	}
+#endif
+}
+} // namespace UTILS
@@ -0,0 +1,48 @@
+#ifndef FILE_WATCHER_HPP
+#define FILE_WATCHER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace UTILS
+{
+// Calls back on a background thread once a file has been written and then left alone for the
+// debounce interval. The parent directory is watched, so editors that replace the file are seen too.
+class FileWatcher
+{
+public:
+	using ChangeCallback = std::function<void()>;
+
+	FileWatcher() = default;
+	~FileWatcher();
+
+	FileWatcher(const FileWatcher&)			   = delete;
+	FileWatcher& operator=(const FileWatcher&) = delete;
+
+	bool start(const fs::path& file_path, std::chrono::milliseconds debounce, ChangeCallback on_change);
+	void stop();
+
+	bool is_running() const;
+
+private:
+	void run();
+
+private:
+	fs::path				  m_file_name;
+	std::chrono::milliseconds m_debounce = std::chrono::milliseconds::zero();
+	ChangeCallback			  m_on_change;
+
+	std::thread		  m_thread;
+	std::atomic<bool> m_running = false;
+
+	int m_inotify_fd = -1;
+	int m_wakeup_fd	 = -1;
+};
+} // namespace UTILS
+
+#endif // FILE_WATCHER_HPP
@@ -0,0 +1,306 @@
+#include "latency_tracker.hpp"
+
+#include "spdlog_wrapper.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace UTILS
+{
+void LatencyHistogram::record(std::chrono::microseconds value)
+{
+	uint64_t sample = static_cast<uint64_t>(std::max<int64_t>(value.count(), 0));
+
+	++this->m_buckets[bucket_index(sample)];
+	++this->m_count;
+	this->m_sum += sample;
+	this->m_max	 = std::max(this->m_max, sample);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other)
+{
+	for (size_t i = 0; i < BUCKET_COUNT; ++i)
+	{
+		this->m_buckets[i] += other.m_buckets[i];
+	}
+
+	this->m_count += other.m_count;
+	this->m_sum	  += other.m_sum;
+	this->m_max	   = std::max(this->m_max, other.m_max);
+}
+
+void LatencyHistogram::reset()
+{
+	this->m_buckets.fill(0);
+	this->m_count = 0;
+	this->m_sum	  = 0;
+	this->m_max	  = 0;
+}
+
+uint64_t LatencyHistogram::count() const
+{
+	return this->m_count;
+}
+
+std::chrono::microseconds LatencyHistogram::max() const
+{
+	return std::chrono::microseconds(this->m_max);
+}
+
+std::chrono::microseconds LatencyHistogram::mean() const
+{
+	return std::chrono::microseconds(this->m_count ? this->m_sum / this->m_count : 0);
+}
+
+std::chrono::microseconds LatencyHistogram::percentile(double percentile) const
+{
+	if (this->m_count == 0)
+	{
+		return std::chrono::microseconds(0);
+	}
+
+	auto	 rank		= static_cast<uint64_t>(std::ceil(std::clamp(percentile, 0.0, 1.0) * static_cast<double>(this->m_count)));
+	uint64_t cumulative = 0;
+
+	rank = std::max<uint64_t>(rank, 1);
+
+	for (size_t i = 0; i < BUCKET_COUNT; ++i)
+	{
+		cumulative += this->m_buckets[i];
+
+		if (cumulative >= rank)
+		{
+			return std::chrono::microseconds(std::min(bucket_upper_bound(i), this->m_max));
+		}
+	}
+
+	return std::chrono::microseconds(this->m_max);
+}
+
+size_t LatencyHistogram::bucket_index(uint64_t value)
+{
+	value = std::min<uint64_t>(value, (uint64_t(1) << MAX_VALUE_BITS) - 1);
+
+	if (value < SUB_BUCKET_COUNT)
+	{
+		return static_cast<size_t>(value);
+	}
+
+	size_t	 exponent = static_cast<size_t>(std::bit_width(value)) - SUB_BUCKET_BITS;
+	uint64_t mantissa = value >> exponent;
+
+	return SUB_BUCKET_COUNT + (exponent - 1) * (SUB_BUCKET_COUNT / 2) + static_cast<size_t>(mantissa - SUB_BUCKET_COUNT / 2);
+}
+
+uint64_t LatencyHistogram::bucket_upper_bound(size_t index)
+{
+	if (index < SUB_BUCKET_COUNT)
+	{
+		return index;
+	}
+
+	size_t	 offset	  = index - SUB_BUCKET_COUNT;
+	size_t	 exponent = offset / (SUB_BUCKET_COUNT / 2) + 1;
+	uint64_t mantissa = offset % (SUB_BUCKET_COUNT / 2) + SUB_BUCKET_COUNT / 2;
+
+	return ((mantissa + 1) << exponent) - 1;
+}
+
+void LatencyTracker::set_options(const LatencyTrackerOptions& options)
+{
+	std::lock_guard<std::mutex> lock(this->m_tracker_mutex);
+	this->m_options = options;
+}
+
+LatencyTrackerOptions LatencyTracker::get_options() const
+{
+	std::lock_guard<std::mutex> lock(this->m_tracker_mutex);
+	return this->m_options;
+}
+
+void LatencyTracker::record(std::string_view host, const TransferTiming& timing)
+{
+	auto now = std::chrono::steady_clock::now();
+
+	std::lock_guard<std::mutex> lock(this->m_tracker_mutex);
+
+	auto [iterator, inserted] = this->m_hosts.try_emplace(std::string(host));
+	HostLatency& latency	  = iterator->second;
+
+	if (inserted)
+	{
+		latency.window_start = now;
+	}
+
+	this->rotate(latency, now);
+
+	HostLatencyHistograms& lifetime = latency.lifetime;
+
+	latency.current_total.record(timing.total);
+	lifetime.total.record(timing.total);
+	lifetime.server_wait.record(timing.start_transfer - std::max(timing.app_connect, timing.connect));
+	lifetime.bytes_downloaded += timing.bytes_downloaded;
+	lifetime.bytes_uploaded	  += timing.bytes_uploaded;
+
+	if (timing.connection_reused || timing.connect.count() == 0)
+	{
+		++lifetime.reused_connections;
+		return;
+	}
+
+	++lifetime.new_connections;
+	latency.current_connect.record(timing.connect);
+	lifetime.name_lookup.record(timing.name_lookup);
+	lifetime.connect.record(timing.connect - timing.name_lookup);
+
+	if (timing.app_connect > timing.connect)
+	{
+		lifetime.tls_handshake.record(timing.app_connect - timing.connect);
+	}
+}
+
+std::optional<HostLatencyProfile> LatencyTracker::get_profile(std::string_view host)
+{
+	auto now = std::chrono::steady_clock::now();
+
+	std::lock_guard<std::mutex> lock(this->m_tracker_mutex);
+
+	auto iterator = this->m_hosts.find(std::string(host));
+
+	if (iterator == this->m_hosts.end())
+	{
+		return std::nullopt;
+	}
+
+	HostLatency& latency = iterator->second;
+	this->rotate(latency, now);
+
+	LatencyHistogram total = latency.current_total;
+	total.merge(latency.previous_total);
+
+	if (total.count() < this->m_options.min_samples)
+	{
+		return std::nullopt;
+	}
+
+	LatencyHistogram connect = latency.current_connect;
+	connect.merge(latency.previous_connect);
+
+	auto scale = [multiplier = this->m_options.timeout_multiplier](std::chrono::microseconds value) {
+		return std::chrono::microseconds(static_cast<int64_t>(static_cast<double>(value.count()) * multiplier));
+	};
+
+	HostLatencyProfile profile;
+	profile.samples		  = total.count();
+	profile.hedge_delay	  = std::max<std::chrono::microseconds>(total.percentile(this->m_options.hedge_percentile),
+																  this->m_options.min_hedge_delay);
+	profile.total_timeout = std::max<std::chrono::microseconds>(scale(total.percentile(this->m_options.timeout_percentile)),
+																this->m_options.min_total_timeout);
+
+	if (connect.count() >= this->m_options.min_samples)
+	{
+		profile.connect_timeout = std::max<std::chrono::microseconds>(scale(connect.percentile(this->m_options.timeout_percentile)),
+																	  this->m_options.min_connect_timeout);
+	}
+
+	return profile;
+}
+
+std::optional<HostLatencyHistograms> LatencyTracker::get_histograms(std::string_view host) const
+{
+	std::lock_guard<std::mutex> lock(this->m_tracker_mutex);
+
+	auto iterator = this->m_hosts.find(std::string(host));
+
+	if (iterator == this->m_hosts.end())
+	{
+		return std::nullopt;
+	}
+
+	return iterator->second.lifetime;
+}
+
+std::vector<std::pair<std::string, HostLatencyHistograms>> LatencyTracker::get_histograms() const
+{
+	std::lock_guard<std::mutex> lock(this->m_tracker_mutex);
+
+	std::vector<std::pair<std::string, HostLatencyHistograms>> histograms;
+	histograms.reserve(this->m_hosts.size());
+
+	for (const auto& [host, latency] : this->m_hosts)
+	{
+		histograms.emplace_back(host, latency.lifetime);
+	}
+
+	return histograms;
+}
+
+void LatencyTracker::dump() const
+{
+	auto histograms = this->get_histograms();
+
+	for (const auto& [host, latency] : histograms)
+	{
+		SPD_INFO_CLASS(COMMON::d_settings_group_utils,
+					   fmt::format("Latency for {}: {} requests, {} new and {} reused connections, {} bytes down, {} bytes up",
+								   host,
+								   latency.total.count(),
+								   latency.new_connections,
+								   latency.reused_connections,
+								   latency.bytes_downloaded,
+								   latency.bytes_uploaded));
+
+		const std::pair<std::string_view, const LatencyHistogram*> phases[] = {
+			{"dns", &latency.name_lookup},
+			{"connect", &latency.connect},
+			{"tls", &latency.tls_handshake},
+			{"server", &latency.server_wait},
+			{"total", &latency.total},
+		};
+
+		for (const auto& [name, histogram] : phases)
+		{
+			if (histogram->count() == 0)
+			{
+				continue;
+			}
+
+			SPD_INFO_CLASS(COMMON::d_settings_group_utils,
+						   fmt::format("  {:<8} count {} mean {} us p50 {} us p90 {} us p99 {} us max {} us",
+									   name,
+									   histogram->count(),
+									   histogram->mean().count(),
+									   histogram->percentile(0.5).count(),
+									   histogram->percentile(0.9).count(),
+									   histogram->percentile(0.99).count(),
+									   histogram->max().count()));
+		}
+	}
+}
+
+void LatencyTracker::rotate(HostLatency& latency, std::chrono::steady_clock::time_point now) const
+{
+	auto elapsed = now - latency.window_start;
+
+	if (elapsed < this->m_options.window)
+	{
+		return;
+	}
+
+	if (elapsed < 2 * this->m_options.window)
+	{
+		latency.previous_total	 = latency.current_total;
+		latency.previous_connect = latency.current_connect;
+	}
+	else
+	{
+		latency.previous_total.reset();
+		latency.previous_connect.reset();
+	}
+
+	latency.current_total.reset();
+	latency.current_connect.reset();
+	latency.window_start = now;
+}
+} // namespace UTILS
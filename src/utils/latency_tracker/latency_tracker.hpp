@@ -0,0 +1,132 @@
+#ifndef LATENCY_TRACKER_HPP
+#define LATENCY_TRACKER_HPP
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace UTILS
+{
+// Log-linear histogram of microsecond latencies with ~3% relative precision per bucket.
+class LatencyHistogram
+{
+public:
+	void record(std::chrono::microseconds value);
+	void merge(const LatencyHistogram& other);
+	void reset();
+
+	uint64_t				  count() const;
+	std::chrono::microseconds max() const;
+	std::chrono::microseconds mean() const;
+	std::chrono::microseconds percentile(double percentile) const;
+
+private:
+	static constexpr size_t SUB_BUCKET_BITS	 = 5;
+	static constexpr size_t SUB_BUCKET_COUNT = size_t(1) << SUB_BUCKET_BITS;
+	static constexpr size_t MAX_VALUE_BITS	 = 40;
+	static constexpr size_t BUCKET_COUNT	 = SUB_BUCKET_COUNT + (MAX_VALUE_BITS - SUB_BUCKET_BITS) * (SUB_BUCKET_COUNT / 2);
+
+	static size_t	bucket_index(uint64_t value);
+	static uint64_t bucket_upper_bound(size_t index);
+
+private:
+	std::array<uint64_t, BUCKET_COUNT> m_buckets = {};
+	uint64_t						   m_count	 = 0;
+	uint64_t						   m_sum	 = 0;
+	uint64_t						   m_max	 = 0;
+};
+
+// Phase timestamps are offsets from the start of the transfer, as reported by libcurl.
+struct TransferTiming
+{
+	std::chrono::microseconds name_lookup		= {};
+	std::chrono::microseconds connect			= {};
+	std::chrono::microseconds app_connect		= {};
+	std::chrono::microseconds start_transfer	= {};
+	std::chrono::microseconds total				= {};
+	uint64_t				  bytes_downloaded	= 0;
+	uint64_t				  bytes_uploaded	= 0;
+	bool					  connection_reused	= false;
+};
+
+// Histograms hold the duration of each phase rather than its offset. Connection setup phases are
+// only recorded for transfers that opened a new connection.
+struct HostLatencyHistograms
+{
+	LatencyHistogram name_lookup;
+	LatencyHistogram connect;
+	LatencyHistogram tls_handshake;
+	LatencyHistogram server_wait;
+	LatencyHistogram total;
+
+	uint64_t reused_connections = 0;
+	uint64_t new_connections	= 0;
+	uint64_t bytes_downloaded	= 0;
+	uint64_t bytes_uploaded		= 0;
+};
+
+struct LatencyTrackerOptions
+{
+	double					  hedge_percentile	  = 0.95;
+	double					  timeout_percentile  = 0.99;
+	double					  timeout_multiplier  = 3.0;
+	double					  max_hedge_ratio	  = 0.1;
+	uint64_t				  min_samples		  = 20;
+	std::chrono::milliseconds min_hedge_delay	  = std::chrono::milliseconds(5);
+	std::chrono::milliseconds min_total_timeout	  = std::chrono::milliseconds(1000);
+	std::chrono::milliseconds min_connect_timeout = std::chrono::milliseconds(250);
+	std::chrono::seconds	  window			  = std::chrono::seconds(60);
+};
+
+struct HostLatencyProfile
+{
+	uint64_t				  samples		  = 0;
+	std::chrono::microseconds hedge_delay	  = {};
+	std::chrono::microseconds total_timeout	  = {};
+	std::chrono::microseconds connect_timeout = {};
+};
+
+// Keeps a rolling latency window per host, covering the current and the previous window.
+class LatencyTracker
+{
+public:
+	void				  set_options(const LatencyTrackerOptions& options);
+	LatencyTrackerOptions get_options() const;
+
+	void record(std::string_view host, const TransferTiming& timing);
+
+	std::optional<HostLatencyProfile>						   get_profile(std::string_view host);
+	std::optional<HostLatencyHistograms>					   get_histograms(std::string_view host) const;
+	std::vector<std::pair<std::string, HostLatencyHistograms>> get_histograms() const;
+
+	void dump() const;
+
+private:
+	struct HostLatency
+	{
+		LatencyHistogram					  current_total;
+		LatencyHistogram					  previous_total;
+		LatencyHistogram					  current_connect;
+		LatencyHistogram					  previous_connect;
+		std::chrono::steady_clock::time_point window_start;
+		HostLatencyHistograms				  lifetime;
+	};
+
+	void rotate(HostLatency& latency, std::chrono::steady_clock::time_point now) const;
+
+private:
+	std::unordered_map<std::string, HostLatency> m_hosts;
+	LatencyTrackerOptions						 m_options;
+
+protected:
+	mutable std::mutex m_tracker_mutex;
+};
+} // namespace UTILS
+
+#endif // LATENCY_TRACKER_HPP
@@ -0,0 +1,212 @@
+#include "manager_registry.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <thread>
+
+namespace UTILS
+{
+ManagerRegistry::~ManagerRegistry()
+{
+	this->shutdown_managers();
+}
+
+bool ManagerRegistry::initialize_managers()
+{
+	std::unique_lock<std::mutex> lock(this->m_registry_mutex);
+
+	// Managers initialized by an earlier call are skipped and count as ready dependencies.
+	const size_t					 count = this->m_entries.size();
+	std::vector<bool>				 initialized(count, false);
+	std::vector<size_t>				 pending(count, 0);
+	std::vector<std::vector<size_t>> dependents(count);
+
+	if (this->m_initialized.empty())
+	{
+		this->m_init_timings.clear();
+	}
+
+	for (size_t index : this->m_initialized)
+	{
+		initialized[index] = true;
+	}
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		for (const auto& dependency : this->m_entries[i].dependencies)
+		{
+			size_t position = this->find_entry(dependency);
+
+			if (!initialized[i] && !initialized[position])
+			{
+				dependents[position].push_back(i);
+				++pending[i];
+			}
+		}
+	}
+
+	std::deque<size_t> ready;
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (!initialized[i] && pending[i] == 0)
+		{
+			ready.push_back(i);
+		}
+	}
+
+	const size_t requested	  = count - this->m_initialized.size();
+	const size_t already_done = this->m_initialized.size();
+
+	if (requested == 0)
+	{
+		return true;
+	}
+
+	// A manager that is never released by its dependencies is part of a cycle.
+	{
+		std::vector<size_t> remaining = pending;
+		std::deque<size_t>	order	  = ready;
+		size_t				visited	  = 0;
+
+		for (; !order.empty(); order.pop_front(), ++visited)
+		{
+			for (size_t dependent : dependents[order.front()])
+			{
+				if (--remaining[dependent] == 0)
+				{
+					order.push_back(dependent);
+				}
+			}
+		}
+
+		if (visited != requested)
+		{
+			SPD_ERROR_CLASS(COMMON::d_settings_group_utils, "Unable to initialize managers, their dependencies form a cycle.");
+			return false;
+		}
+	}
+
+	std::condition_variable condition;
+	size_t					running = 0;
+	auto					started = std::chrono::steady_clock::now();
+
+	auto run_worker = [&]() {
+		std::unique_lock<std::mutex> worker_lock(this->m_registry_mutex);
+
+		for (;;)
+		{
+			condition.wait(worker_lock, [&] { return !ready.empty() || running == 0; });
+
+			if (ready.empty())
+			{
+				return;
+			}
+
+			size_t index = ready.front();
+			ready.pop_front();
+			++running;
+
+			worker_lock.unlock();
+
+			auto			 start = std::chrono::steady_clock::now();
+			std::string_view name;
+			std::string		 error;
+
+			try
+			{
+				name = this->m_entries[index].initialize();
+			}
+			catch (const std::exception& e)
+			{
+				error = e.what();
+			}
+
+			auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+			worker_lock.lock();
+			--running;
+
+			// Managers that depend on a failed one are left uninitialized.
+			if (error.empty())
+			{
+				this->m_initialized.push_back(index);
+				this->m_init_timings.push_back({std::string(name), duration});
+
+				for (size_t dependent : dependents[index])
+				{
+					if (--pending[dependent] == 0)
+					{
+						ready.push_back(dependent);
+					}
+				}
+			}
+			else
+			{
+				SPD_ERROR_CLASS(COMMON::d_settings_group_utils, fmt::format("Failed to initialize manager: {}", error));
+			}
+
+			condition.notify_all();
+		}
+	};
+
+	size_t worker_count = std::clamp<size_t>(std::thread::hardware_concurrency(), 1, requested);
+
+	lock.unlock();
+
+	std::vector<std::thread> workers;
+	for (size_t i = 1; i < worker_count; ++i)
+	{
+		workers.emplace_back(run_worker);
+	}
+
+	run_worker();
+
+	for (auto& worker : workers)
+	{
+		worker.join();
+	}
+
+	lock.lock();
+
+	const size_t finished = this->m_initialized.size() - already_done;
+
+	for (auto timing = this->m_init_timings.end() - static_cast<std::ptrdiff_t>(finished); timing != this->m_init_timings.end(); ++timing)
+	{
+		SPD_DEBUG_CLASS(COMMON::d_settings_group_utils, fmt::format("Initialized {} in {} us", timing->name, timing->duration.count()));
+	}
+
+	auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started);
+	SPD_INFO_CLASS(COMMON::d_settings_group_utils, fmt::format("Initialized {} of {} managers in {} us", finished, requested, elapsed.count()));
+
+	return finished == requested;
+}
+
+void ManagerRegistry::shutdown_managers()
+{
+	std::vector<size_t> initialized;
+	{
+		std::lock_guard<std::mutex> lock(this->m_registry_mutex);
+		initialized.swap(this->m_initialized);
+	}
+
+	for (auto index = initialized.rbegin(); index != initialized.rend(); ++index)
+	{
+		this->m_entries[*index].shutdown();
+	}
+}
+
+std::vector<ManagerInitTiming> ManagerRegistry::get_init_timings() const
+{
+	std::lock_guard<std::mutex> lock(this->m_registry_mutex);
+	return this->m_init_timings;
+}
+
+// Callers hold m_registry_mutex.
+size_t ManagerRegistry::find_entry(std::type_index id) const
+{
+	auto entry = std::find_if(this->m_entries.begin(), this->m_entries.end(), [&id](const ManagerEntry& candidate) { return candidate.id == id; });
+	return entry != this->m_entries.end() ? static_cast<size_t>(entry - this->m_entries.begin()) : NOT_FOUND;
+}
+} // namespace UTILS
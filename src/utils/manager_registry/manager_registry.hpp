@@ -0,0 +1,92 @@
+#ifndef MANAGER_REGISTRY_HPP
+#define MANAGER_REGISTRY_HPP
+
+#include "manager_singleton.hpp"
+
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <typeindex>
+#include <typeinfo>
+#include <vector>
+
+namespace UTILS
+{
+struct ManagerInitTiming
+{
+	std::string				  name;
+	std::chrono::microseconds duration = std::chrono::microseconds::zero();
+};
+
+// Creates managers up front instead of on first use. Managers whose dependencies are ready are initialized
+// in parallel, shutdown runs in the reverse of the order in which their initialization finished.
+class ManagerRegistry
+{
+public:
+	ManagerRegistry() = default;
+	~ManagerRegistry();
+
+	ManagerRegistry(const ManagerRegistry&)			   = delete;
+	ManagerRegistry& operator=(const ManagerRegistry&) = delete;
+
+	// The dependencies a manager declares are registered along with it.
+	template<typename Manager>
+	void add_manager()
+	{
+		this->register_manager<Manager>(typename Manager::Dependencies {});
+	}
+
+	// Initializes the managers added since the previous call, so startup can happen in stages.
+	bool initialize_managers();
+	void shutdown_managers();
+
+	// In the order the managers finished initializing.
+	std::vector<ManagerInitTiming> get_init_timings() const;
+
+private:
+	struct ManagerEntry
+	{
+		std::type_index					  id;
+		std::vector<std::type_index>	  dependencies;
+		std::function<std::string_view()> initialize;
+		std::function<void()>			  shutdown;
+	};
+
+	// The entry is added before its dependencies, so a dependency cycle ends the recursion and is reported on initialization.
+	template<typename Manager, typename... Dependencies>
+	void register_manager(ManagerDependencies<Dependencies...>)
+	{
+		{
+			std::lock_guard<std::mutex> lock(this->m_registry_mutex);
+
+			if (this->find_entry(typeid(Manager)) != NOT_FOUND)
+			{
+				return;
+			}
+
+			this->m_entries.push_back(ManagerEntry {typeid(Manager),
+													{std::type_index(typeid(Dependencies))...},
+													[] { return Manager::instance_ref().get_manager_name(); },
+													[] { Manager::instance_ref().shutdown(); }});
+		}
+
+		(this->add_manager<Dependencies>(), ...);
+	}
+
+	size_t find_entry(std::type_index id) const;
+
+private:
+	static constexpr size_t NOT_FOUND = static_cast<size_t>(-1);
+
+	std::vector<ManagerEntry>	   m_entries;
+	std::vector<size_t>			   m_initialized;
+	std::vector<ManagerInitTiming> m_init_timings;
+
+protected:
+	mutable std::mutex m_registry_mutex;
+};
+} // namespace UTILS
+
+#endif // MANAGER_REGISTRY_HPP
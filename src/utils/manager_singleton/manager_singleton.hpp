@@ -3,27 +3,42 @@
 
 #include "spdlog_wrapper.hpp"
 
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <string_view>
 
 namespace UTILS
 {
+// Managers that have to be initialized before a manager and shut down after it, see ManagerRegistry.
+template<typename... Managers>
+struct ManagerDependencies
+{
+};
+
 template<typename Derived>
 class ManagerSingleton
 {
 public:
+	using Dependencies = ManagerDependencies<>;
+
 	static std::shared_ptr<Derived> instance()
 	{
-		std::lock_guard<std::mutex> lock(m_mutex);
-		if (!m_instance)
-		{
-			m_instance = std::shared_ptr<Derived>(new Derived());
+		std::call_once(m_once, create_instance);
+		return m_instance;
+	}
 
-			SPD_DEBUG_CLASS(COMMON::d_settings_group_utils, fmt::format("Initializing {}", m_instance->get_manager_name()));
-			m_instance->initialize();
+	// Once the instance exists this is a single acquire load, without locking or reference counting.
+	// The instance is never released, so the reference stays valid for the lifetime of the program.
+	static Derived& instance_ref()
+	{
+		if (Derived* instance = m_instance_pointer.load(std::memory_order_acquire))
+		{
+			return *instance;
 		}
-		return m_instance;
+
+		std::call_once(m_once, create_instance);
+		return *m_instance;
 	}
 
 	virtual ~ManagerSingleton() = default;
@@ -31,17 +46,33 @@ public:
 	virtual std::string_view get_manager_name() const = 0;
 	virtual void			 initialize()			  = 0;
 
+	// Stops background work while the managers it depends on are still running. Must be safe to call twice.
+	virtual void shutdown() {}
+
 protected:
 	ManagerSingleton() = default;
 
 private:
+	// Published only after initialize() succeeds, a throwing initialize() leaves the next call to retry.
+	static void create_instance()
+	{
+		auto instance = std::shared_ptr<Derived>(new Derived());
+
+		SPD_DEBUG_CLASS(COMMON::d_settings_group_utils, fmt::format("Initializing {}", instance->get_manager_name()));
+		instance->initialize();
+
+		m_instance = std::move(instance);
+		m_instance_pointer.store(m_instance.get(), std::memory_order_release);
+	}
+
 	ManagerSingleton(const ManagerSingleton&)			 = delete;
 	ManagerSingleton(ManagerSingleton&&)				 = delete;
 	ManagerSingleton& operator=(const ManagerSingleton&) = delete;
 	ManagerSingleton& operator=(ManagerSingleton&&)		 = delete;
 
 	static inline std::shared_ptr<Derived> m_instance;
-	static inline std::mutex			   m_mutex;
+	static inline std::atomic<Derived*>	   m_instance_pointer = nullptr;
+	static inline std::once_flag		   m_once;
 };
 
 } // namespace UTILS
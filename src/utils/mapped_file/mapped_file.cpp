@@ -0,0 +1,139 @@
+#include "mapped_file.hpp"
+
+#include <fstream>
+#include <utility>
+
+#if defined(__unix__) || defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace UTILS
+{
+MappedFile::~MappedFile()
+{
+	this->close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+	*this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+	if (this != &other)
+	{
+		this->close();
+
+		this->m_data			= std::exchange(other.m_data, nullptr);
+		this->m_size			= std::exchange(other.m_size, 0);
+		this->m_mapped			= std::exchange(other.m_mapped, false);
+		this->m_open			= std::exchange(other.m_open, false);
+		this->m_fallback_buffer = std::move(other.m_fallback_buffer);
+	}
+	return *this;
+}
+
+bool MappedFile::open(const fs::path& file_path)
+{
+	this->close();
+
+#if defined(__unix__) || defined(__linux__)
+	int fd = ::open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+
+	if (fd < 0)
+	{
+		return false;
+	}
+
+	struct stat file_stat {};
+
+	if (fstat(fd, &file_stat) != 0)
+	{
+		::close(fd);
+		return false;
+	}
+
+	this->m_size = static_cast<size_t>(file_stat.st_size);
+
+	if (this->m_size > 0)
+	{
+		void* mapping = mmap(nullptr, this->m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+		if (mapping == MAP_FAILED)
+		{
+			::close(fd);
+			this->m_size = 0;
+			return false;
+		}
+
+		this->m_data   = static_cast<const std::byte*>(mapping);
+		this->m_mapped = true;
+	}
+
+	::close(fd);
+#else
+	std::ifstream file(file_path, std::ios::binary | std::ios::ate);
+
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	this->m_fallback_buffer.resize(static_cast<size_t>(file.tellg()));
+	file.seekg(0, std::ios::beg);
+	file.read(reinterpret_cast<char*>(this->m_fallback_buffer.data()), static_cast<std::streamsize>(this->m_fallback_buffer.size()));
+
+	this->m_data = this->m_fallback_buffer.data();
+	this->m_size = this->m_fallback_buffer.size();
+#endif
+
+	this->m_open = true;
+	return true;
+}
+
+void MappedFile::close()
+{
+#if defined(__unix__) || defined(__linux__)
+	if (this->m_mapped)
+	{
+		munmap(const_cast<std::byte*>(this->m_data), this->m_size);
+	}
+#endif
+
+	this->m_data   = nullptr;
+	this->m_size   = 0;
+	this->m_mapped = false;
+	this->m_open   = false;
+	this->m_fallback_buffer.clear();
+}
+
+bool MappedFile::is_open() const
+{
+	return this->m_open;
+}
+
+size_t MappedFile::size() const
+{
+	return this->m_size;
+}
+
+std::span<const std::byte> MappedFile::data() const
+{
+	return {this->m_data, this->m_size};
+}
+
+void MappedFile::advise_sequential() const
+{
+#if defined(__unix__) || defined(__linux__)
+	if (this->m_mapped)
+	{
+		madvise(const_cast<std::byte*>(this->m_data), this->m_size, MADV_SEQUENTIAL);
+		madvise(const_cast<std::byte*>(this->m_data), this->m_size, MADV_WILLNEED);
+	}
+#endif
+}
+} // namespace UTILS
@@ -0,0 +1,44 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace UTILS
+{
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	~MappedFile();
+
+	MappedFile(MappedFile&& other) noexcept;
+	MappedFile& operator=(MappedFile&& other) noexcept;
+
+	MappedFile(const MappedFile&)			 = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool open(const fs::path& file_path);
+	void close();
+
+	bool					   is_open() const;
+	size_t					   size() const;
+	std::span<const std::byte> data() const;
+
+	void advise_sequential() const;
+
+private:
+	const std::byte* m_data	  = nullptr;
+	size_t			 m_size	  = 0;
+	bool			 m_mapped = false;
+	bool			 m_open	  = false;
+
+	std::vector<std::byte> m_fallback_buffer;
+};
+} // namespace UTILS
+
+#endif // MAPPED_FILE_HPP
@@ -1,31 +1,292 @@
 #include "network_manager.hpp"
 
+#include "response_cache.hpp"
+#include "segmented_download.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstring>
 #include <fstream>
 #include <memory>
 
+#if defined(__linux__)
+#include <cerrno>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+constexpr long UPLOAD_BUFFER_SIZE = 512L * 1024L;
+
+bool is_streaming(const UTILS::NetworkRequest& request)
+{
+	return request.chunk_consumer || !request.download_file_path.empty() || !request.upload_file_path.empty();
+}
+
+bool is_hedgeable(const UTILS::NetworkRequest& request)
+{
+	bool idempotent = request.method == UTILS::HttpMethod::GET || request.method == UTILS::HttpMethod::PUT ||
+					  request.method == UTILS::HttpMethod::DELETE;
+	return request.hedge && idempotent && !is_streaming(request);
+}
+
+UTILS::TransferTiming get_transfer_timing(CURL* curl)
+{
+	auto get_time = [curl](CURLINFO info) {
+		curl_off_t value = 0;
+		curl_easy_getinfo(curl, info, &value);
+		return std::chrono::microseconds(value);
+	};
+
+	auto get_size = [curl](CURLINFO info) {
+		curl_off_t value = 0;
+		curl_easy_getinfo(curl, info, &value);
+		return static_cast<uint64_t>(std::max<curl_off_t>(value, 0));
+	};
+
+	long new_connections = 0;
+	curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &new_connections);
+
+	UTILS::TransferTiming timing;
+	timing.name_lookup		 = get_time(CURLINFO_NAMELOOKUP_TIME_T);
+	timing.connect			 = get_time(CURLINFO_CONNECT_TIME_T);
+	timing.app_connect		 = get_time(CURLINFO_APPCONNECT_TIME_T);
+	timing.start_transfer	 = get_time(CURLINFO_STARTTRANSFER_TIME_T);
+	timing.total			 = get_time(CURLINFO_TOTAL_TIME_T);
+	timing.bytes_downloaded	 = get_size(CURLINFO_SIZE_DOWNLOAD_T);
+	timing.bytes_uploaded	 = get_size(CURLINFO_SIZE_UPLOAD_T);
+	timing.connection_reused = new_connections == 0;
+
+	return timing;
+}
+} // anonymous namespace
+
 namespace UTILS
 {
-std::mutex NetworkManager::m_network_mutex;
+// Everything about a request that does not change between executions.
+struct RequestTemplate
+{
+	NetworkRequest	   request;
+	std::string		   host;
+	std::string		   userpwd;
+	struct curl_slist* header_list			  = nullptr;
+	struct curl_slist* compressed_header_list = nullptr;
+
+	explicit RequestTemplate(NetworkRequest source) :
+		request(std::move(source)),
+		host(ConnectionPool::extract_host(request.url))
+	{
+		if (!request.username.empty() || !request.password.empty())
+		{
+			userpwd = fmt::format("{}:{}", request.username, request.password);
+		}
+
+		for (const auto& header : request.headers)
+		{
+			std::string line = fmt::format("{}: {}", header.first, header.second);
+
+			header_list = curl_slist_append(header_list, line.c_str());
+
+			if (request.compress_body)
+			{
+				compressed_header_list = curl_slist_append(compressed_header_list, line.c_str());
+			}
+		}
+
+		if (request.compress_body)
+		{
+			compressed_header_list = curl_slist_append(compressed_header_list, "Content-Encoding: gzip");
+		}
+	}
+
+	~RequestTemplate()
+	{
+		if (header_list)
+		{
+			curl_slist_free_all(header_list);
+		}
+		if (compressed_header_list)
+		{
+			curl_slist_free_all(compressed_header_list);
+		}
+	}
+
+	RequestTemplate(const RequestTemplate&)			   = delete;
+	RequestTemplate& operator=(const RequestTemplate&) = delete;
+};
+
+struct NetworkTransfer
+{
+	NetworkTransferId					   id = 0;
+	std::shared_ptr<const RequestTemplate> prepared;
+	NetworkResponse						   response;
+	NetworkCallback						   callback;
+
+	std::string				   payload;
+	std::span<const std::byte> body;
+
+	CurlHandle curl;
+
+	MappedFile					   upload_file;
+	std::span<const std::byte>	   upload_data;
+	size_t						   upload_offset = 0;
+	std::unique_ptr<std::ofstream> output_file;
+
+	std::string compressed_body;
+	char		error_buffer[CURL_ERROR_SIZE] = {0};
+
+	std::optional<HostLatencyProfile> latency_profile;
+	NetworkTransferId				  hedge_partner = 0;
+};
+
+const std::string& get_default_user_agent()
+{
+	static const std::string user_agent = std::format("Mozilla/5.0 ({}; {}) {}/{}",
+													  COMMON::d_system_name,
+													  COMMON::d_system_version,
+													  COMMON::d_project_name,
+													  COMMON::d_project_version);
+	return user_agent;
+}
+
+PreparedRequest::PreparedRequest(NetworkRequest request) :
+	m_template(std::make_shared<const RequestTemplate>(std::move(request)))
+{}
+
+bool PreparedRequest::is_valid() const
+{
+	return this->m_template != nullptr;
+}
+
+const NetworkRequest& PreparedRequest::get_request() const
+{
+	return this->m_template->request;
+}
+
+std::optional<std::string_view> NetworkResponse::get_header(std::string_view name) const
+{
+	auto iterator = std::ranges::find_if(this->headers, [name](const auto& header) {
+		return std::ranges::equal(header.first, name, [](char lhs, char rhs) {
+			return std::tolower(static_cast<unsigned char>(lhs)) == std::tolower(static_cast<unsigned char>(rhs));
+		});
+	});
+
+	if (iterator == this->headers.end())
+	{
+		return std::nullopt;
+	}
+
+	return iterator->second;
+}
+
+NetworkManager::NetworkManager() = default;
 
 NetworkManager::~NetworkManager()
 {
-	cleanup();
+	this->shutdown();
 }
 
 void NetworkManager::initialize()
 {
 	curl_global_init(CURL_GLOBAL_ALL);
 
-	this->m_curl.reset(curl_easy_init());
+	this->m_multi.reset(curl_multi_init());
+
+	if (!this->m_multi)
+	{
+		SPD_ERROR_CLASS(COMMON::d_settings_group_utils, "Failed to initialize CURL multi handle.");
+		return;
+	}
+
+	if (!this->m_connection_pool.initialize())
+	{
+		this->m_multi.reset();
+		return;
+	}
+
+	this->apply_pool_options();
+
+#if defined(__linux__)
+	this->m_epoll_fd  = epoll_create1(EPOLL_CLOEXEC);
+	this->m_wakeup_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
 
-	if (!m_curl)
+	if (this->m_epoll_fd < 0 || this->m_wakeup_fd < 0)
 	{
-		SPD_ERROR_CLASS(COMMON::d_settings_group_utils, "Failed to initialize CURL handle.");
+		SPD_ERROR_CLASS(COMMON::d_settings_group_utils, "Failed to create network event loop descriptors.");
+		this->m_multi.reset();
+		return;
 	}
+
+	epoll_event wakeup_event {};
+	wakeup_event.events	 = EPOLLIN;
+	wakeup_event.data.fd = this->m_wakeup_fd;
+	epoll_ctl(this->m_epoll_fd, EPOLL_CTL_ADD, this->m_wakeup_fd, &wakeup_event);
+
+	curl_multi_setopt(this->m_multi.get(), CURLMOPT_SOCKETFUNCTION, socket_callback);
+	curl_multi_setopt(this->m_multi.get(), CURLMOPT_SOCKETDATA, this);
+	curl_multi_setopt(this->m_multi.get(), CURLMOPT_TIMERFUNCTION, timer_callback);
+	curl_multi_setopt(this->m_multi.get(), CURLMOPT_TIMERDATA, this);
+#endif
+
+	this->m_running		 = true;
+	this->m_event_thread = std::thread(&NetworkManager::event_loop, this);
 }
 
-void NetworkManager::cleanup()
+void NetworkManager::shutdown()
 {
+	if (this->m_running.exchange(false))
+	{
+		this->wakeup();
+	}
+
+	if (this->m_event_thread.joinable())
+	{
+		this->m_event_thread.join();
+		this->m_latency_tracker.dump();
+	}
+
+	for (auto& [curl, transfer] : this->m_active_transfers)
+	{
+		curl_multi_remove_handle(this->m_multi.get(), curl);
+		transfer->response.error = "Network manager is shutting down.";
+		this->finish_transfer(std::move(transfer));
+	}
+	this->m_active_transfers.clear();
+	this->m_active_transfer_ids.clear();
+
+	std::deque<std::unique_ptr<NetworkTransfer>> pending;
+	{
+		std::lock_guard<std::mutex> lock(this->m_network_mutex);
+		pending.swap(this->m_pending_transfers);
+	}
+
+	for (auto& transfer : pending)
+	{
+		transfer->response.error = "Network manager is shutting down.";
+		this->finish_transfer(std::move(transfer));
+	}
+
+	this->run_timers(std::chrono::steady_clock::time_point::max());
+
+	this->m_connection_pool.cleanup();
+	this->m_multi.reset();
+
+#if defined(__linux__)
+	if (this->m_wakeup_fd >= 0)
+	{
+		close(this->m_wakeup_fd);
+		this->m_wakeup_fd = -1;
+	}
+	if (this->m_epoll_fd >= 0)
+	{
+		close(this->m_epoll_fd);
+		this->m_epoll_fd = -1;
+	}
+#endif
+
 	curl_global_cleanup();
 }
 
@@ -34,121 +295,288 @@ std::string_view NetworkManager::get_manager_name() const
 	return "Network Manager";
 }
 
-NetworkResponse NetworkManager::make_request(const NetworkRequest& request)
+std::future<NetworkResponse> NetworkManager::make_request_async(NetworkRequest request)
+{
+	auto promise = std::make_shared<std::promise<NetworkResponse>>();
+	auto future	 = promise->get_future();
+
+	this->make_request_async(std::move(request), [promise](NetworkResponse response) {
+		promise->set_value(std::move(response));
+	});
+
+	return future;
+}
+
+NetworkTransferId NetworkManager::make_request_async(NetworkRequest request, NetworkCallback callback)
 {
-	std::lock_guard<std::mutex> lock(m_network_mutex);
-	NetworkResponse				response;
+	auto response_cache = this->m_response_cache.load();
 
-	if (!this->m_curl)
+	if (!response_cache || !ResponseCache::is_cacheable(request))
 	{
-		response.error = "CURL handle is not initialized.";
-		SPD_ERROR_CLASS(COMMON::d_settings_group_utils, response.error);
-		return response;
+		return this->submit_transfer(std::move(request), std::move(callback));
 	}
 
-	curl_easy_reset(this->m_curl.get());
+	CachedResponse cached = response_cache->lookup(request);
+
+	if (cached.status == CacheLookupResult::FRESH)
+	{
+		SPD_DEBUG_CLASS(COMMON::d_settings_group_utils, fmt::format("Request to {} served from cache", request.url));
 
-	char error_buffer[CURL_ERROR_SIZE] = {0};
-	set_common_options(request, error_buffer);
+		// Delivered through the event loop like every other response, never on the calling thread.
+		this->schedule(std::chrono::steady_clock::now(), [callback = std::move(callback), response = std::move(cached.response)]() mutable {
+			callback(std::move(response));
+		});
 
-	switch (request.method)
+		return this->m_next_transfer_id++;
+	}
+
+	NetworkRequest conditional_request = request;
+	bool		   revalidating		   = cached.status == CacheLookupResult::STALE;
+
+	if (revalidating && !cached.etag.empty())
 	{
-		case HttpMethod::POST: {
-			curl_easy_setopt(this->m_curl.get(), CURLOPT_POST, 1L);
-			curl_easy_setopt(this->m_curl.get(), CURLOPT_POSTFIELDS, request.body.c_str());
-			break;
-		}
-		case HttpMethod::PUT: {
-			curl_easy_setopt(this->m_curl.get(), CURLOPT_CUSTOMREQUEST, "PUT");
+		conditional_request.headers.emplace_back("If-None-Match", cached.etag);
+	}
+	if (revalidating && !cached.last_modified.empty())
+	{
+		conditional_request.headers.emplace_back("If-Modified-Since", cached.last_modified);
+	}
 
-			if (!request.upload_file_path.empty())
-			{
-				auto input_file = std::make_unique<std::ifstream>(request.upload_file_path, std::ios::binary);
+	return this->submit_transfer(std::move(conditional_request),
+								 [response_cache,
+								  revalidating,
+								  request  = std::move(request),
+								  cached   = std::move(cached.response),
+								  callback = std::move(callback)](NetworkResponse response) mutable {
+									 if (revalidating && response.error.empty() && response.http_code == 304)
+									 {
+										 response = response_cache->revalidate(request, std::move(cached), response);
+									 }
+									 else
+									 {
+										 if (revalidating)
+										 {
+											 response_cache->record_miss();
+										 }
+										 response_cache->store(request, response);
+									 }
+									 callback(std::move(response));
+								 });
+}
 
-				if (!input_file->is_open())
-				{
-					response.error = fmt::format("Failed to open file for upload: {}", request.upload_file_path);
-					SPD_ERROR_CLASS(COMMON::d_settings_group_utils, response.error);
-					return response;
-				}
+NetworkTransferId NetworkManager::submit_transfer(NetworkRequest request, NetworkCallback callback)
+{
+	auto transfer	   = std::make_unique<NetworkTransfer>();
+	transfer->prepared = std::make_shared<const RequestTemplate>(std::move(request));
+	transfer->callback = std::move(callback);
 
-				input_file->seekg(0, std::ios::end);
-				long long file_size = input_file->tellg();
-				input_file->seekg(0, std::ios::beg);
+	const NetworkRequest& prepared_request = transfer->prepared->request;
+	transfer->body = prepared_request.body_view.empty() ? std::as_bytes(std::span(prepared_request.body)) : prepared_request.body_view;
 
-				curl_easy_setopt(this->m_curl.get(), CURLOPT_UPLOAD, 1L);
-				curl_easy_setopt(this->m_curl.get(), CURLOPT_READFUNCTION, read_callback);
-				curl_easy_setopt(this->m_curl.get(), CURLOPT_READDATA, input_file.get());
-				curl_easy_setopt(this->m_curl.get(), CURLOPT_INFILESIZE_LARGE, file_size);
-			}
-			else
-			{
-				curl_easy_setopt(this->m_curl.get(), CURLOPT_POSTFIELDS, request.body.c_str());
-			}
-			break;
-		}
-		case HttpMethod::DELETE: {
-			curl_easy_setopt(this->m_curl.get(), CURLOPT_CUSTOMREQUEST, "DELETE");
-			break;
-		}
-		case HttpMethod::GET:
-		default:
-			break;
+	return this->submit_transfer(std::move(transfer));
+}
+
+NetworkTransferId NetworkManager::submit_transfer(std::unique_ptr<NetworkTransfer> transfer)
+{
+	transfer->id = this->m_next_transfer_id++;
+
+	NetworkTransferId transfer_id = transfer->id;
+
+	if (!this->m_running)
+	{
+		transfer->response.error = "Network event loop is not running.";
+		SPD_ERROR_CLASS(COMMON::d_settings_group_utils, transfer->response.error);
+		this->finish_transfer(std::move(transfer));
+		return transfer_id;
 	}
 
-	struct curl_slist* header_list = nullptr;
+	if (!this->prepare_transfer(*transfer))
+	{
+		this->finish_transfer(std::move(transfer));
+		return transfer_id;
+	}
 
-	for (const auto& header : request.headers)
 	{
-		header_list = curl_slist_append(header_list, fmt::format("{}: {}", header.first, header.second).c_str());
+		std::lock_guard<std::mutex> lock(this->m_network_mutex);
+		this->m_pending_transfers.push_back(std::move(transfer));
 	}
 
-	if (header_list)
+	this->wakeup();
+
+	return transfer_id;
+}
+
+void NetworkManager::resume_transfer(NetworkTransferId transfer_id)
+{
 	{
-		curl_easy_setopt(this->m_curl.get(), CURLOPT_HTTPHEADER, header_list);
+		std::lock_guard<std::mutex> lock(this->m_network_mutex);
+		this->m_resume_requests.push_back(transfer_id);
 	}
 
-	std::unique_ptr<std::ofstream> output_file;
+	this->wakeup();
+}
 
-	if (!request.download_file_path.empty())
+void NetworkManager::cancel_transfer(NetworkTransferId transfer_id, std::string reason)
+{
+	{
+		std::lock_guard<std::mutex> lock(this->m_network_mutex);
+		this->m_cancel_requests.emplace_back(transfer_id, std::move(reason));
+	}
+
+	this->wakeup();
+}
+
+Task<NetworkResponse> NetworkManager::request(NetworkRequest request, std::stop_token stop_token)
+{
+	co_return co_await this->request(std::move(request), std::chrono::milliseconds::zero(), std::move(stop_token));
+}
+
+Task<NetworkResponse> NetworkManager::request(NetworkRequest request, std::chrono::milliseconds timeout, std::stop_token stop_token)
+{
+	struct RequestState
+	{
+		NetworkResponse			response;
+		std::coroutine_handle<> coroutine;
+		std::atomic<bool>		completed = false;
+	};
+
+	struct RequestAwaiter
 	{
-		output_file = std::make_unique<std::ofstream>(request.download_file_path, std::ios::binary);
+		NetworkManager*											 manager;
+		NetworkRequest											 request;
+		std::chrono::milliseconds								 timeout;
+		std::stop_token											 stop_token;
+		std::shared_ptr<RequestState>							 state		   = std::make_shared<RequestState>();
+		std::optional<std::stop_callback<std::function<void()>>> stop_callback = std::nullopt;
 
-		if (!output_file->is_open())
+		bool await_ready() const noexcept
 		{
-			response.error = fmt::format("Failed to open file for writing: {}", request.download_file_path);
+			return false;
+		}
+
+		// The transfer can only resume the coroutine after the final exchange, so the awaiter stays valid until then.
+		bool await_suspend(std::coroutine_handle<> coroutine)
+		{
+			this->state->coroutine = coroutine;
 
-			SPD_ERROR_CLASS(COMMON::d_settings_group_utils, response.error);
+			auto on_complete = [state = this->state](NetworkResponse response) {
+				state->response = std::move(response);
 
-			curl_slist_free_all(header_list);
+				if (state->completed.exchange(true))
+				{
+					state->coroutine.resume();
+				}
+			};
+
+			NetworkTransferId transfer_id = this->manager->make_request_async(std::move(this->request), std::move(on_complete));
+
+			if (this->timeout.count() > 0)
+			{
+				this->manager->schedule(std::chrono::steady_clock::now() + this->timeout, [manager = this->manager, transfer_id] {
+					manager->cancel_transfer(transfer_id, "Request timed out.");
+				});
+			}
 
-			return response;
+			this->stop_callback.emplace(this->stop_token, [manager = this->manager, transfer_id] {
+				manager->cancel_transfer(transfer_id, "Request cancelled.");
+			});
+
+			return !this->state->completed.exchange(true);
 		}
-		curl_easy_setopt(this->m_curl.get(), CURLOPT_WRITEDATA, output_file.get());
-	}
-	else
+
+		NetworkResponse await_resume()
+		{
+			return std::move(this->state->response);
+		}
+	};
+
+	if (stop_token.stop_requested())
 	{
-		curl_easy_setopt(this->m_curl.get(), CURLOPT_WRITEDATA, &response.body);
+		NetworkResponse response;
+		response.error = "Request cancelled.";
+		co_return response;
 	}
 
-	CURLcode res = curl_easy_perform(this->m_curl.get());
+	RequestAwaiter awaiter {this, std::move(request), timeout, std::move(stop_token)};
+	co_return co_await awaiter;
+}
 
-	if (res != CURLE_OK)
+Task<bool> NetworkManager::sleep_for(std::chrono::milliseconds duration, std::stop_token stop_token)
+{
+	struct SleepState
 	{
-		response.error = fmt::format("curl_easy_perform() failed: {}", std::string(error_buffer));
-		SPD_ERROR_CLASS(COMMON::d_settings_group_utils, response.error);
-	}
+		std::coroutine_handle<> coroutine;
+		std::atomic<bool>		completed = false;
+		std::atomic<bool>		suspended = false;
+		bool					elapsed	  = false;
+	};
 
-	curl_easy_getinfo(this->m_curl.get(), CURLINFO_RESPONSE_CODE, &response.http_code);
+	struct SleepAwaiter
+	{
+		NetworkManager*											 manager;
+		std::chrono::milliseconds								 duration;
+		std::stop_token											 stop_token;
+		std::shared_ptr<SleepState>								 state		   = std::make_shared<SleepState>();
+		std::optional<std::stop_callback<std::function<void()>>> stop_callback = std::nullopt;
 
-	if (header_list)
+		static void wake(const std::shared_ptr<SleepState>& state, bool elapsed)
+		{
+			if (state->completed.exchange(true))
+			{
+				return;
+			}
+
+			state->elapsed = elapsed;
+
+			if (state->suspended.exchange(true))
+			{
+				state->coroutine.resume();
+			}
+		}
+
+		bool await_ready() const noexcept
+		{
+			return this->stop_token.stop_requested();
+		}
+
+		bool await_suspend(std::coroutine_handle<> coroutine)
+		{
+			this->state->coroutine = coroutine;
+
+			this->manager->schedule(std::chrono::steady_clock::now() + this->duration, [manager = this->manager, state = this->state] {
+				wake(state, manager->m_running);
+			});
+
+			this->stop_callback.emplace(this->stop_token, [manager = this->manager, state = this->state] {
+				manager->schedule(std::chrono::steady_clock::now(), [state] {
+					wake(state, false);
+				});
+			});
+
+			return !this->state->suspended.exchange(true);
+		}
+
+		bool await_resume() const noexcept
+		{
+			return this->state->elapsed;
+		}
+	};
+
+	SleepAwaiter awaiter {this, duration, std::move(stop_token)};
+	co_return co_await awaiter;
+}
+
+NetworkResponse NetworkManager::make_request(const NetworkRequest& request)
+{
+	if (std::this_thread::get_id() == this->m_event_thread.get_id())
 	{
-		curl_slist_free_all(header_list);
+		NetworkResponse response;
+		response.error = "Blocking requests are not allowed on the network event loop thread.";
+		SPD_ERROR_CLASS(COMMON::d_settings_group_utils, response.error);
+		return response;
 	}
 
-	SPD_DEBUG_CLASS(COMMON::d_settings_group_utils, fmt::format("Request to {} completed with HTTP code {}", request.url, response.http_code));
-
-	return response;
+	return this->make_request_async(request).get();
 }
 
 NetworkResponse NetworkManager::make_request(HttpMethod												 method,
@@ -187,69 +615,1002 @@ bool NetworkManager::download_file(const std::string& url,
 	return response.error.empty() && response.http_code >= 200 && response.http_code < 300;
 }
 
-bool NetworkManager::upload_file(const std::string& url,
-								 const std::string& file_path,
-								 const std::string& user_agent,
-								 const std::string& username,
-								 const std::string& password)
+bool NetworkManager::download_file_segmented(const std::string& url,
+											 const std::string& output_path,
+											 size_t				segment_count,
+											 const std::string& user_agent,
+											 const std::string& username,
+											 const std::string& password)
 {
 	NetworkRequest request;
-	request.method			 = HttpMethod::PUT;
-	request.url				 = url;
-	request.upload_file_path = file_path;
-	request.user_agent		 = user_agent;
-	request.username		 = username;
-	request.password		 = password;
+	request.url		   = url;
+	request.user_agent = user_agent;
+	request.username   = username;
+	request.password   = password;
 
-	NetworkResponse response = make_request(request);
-	return response.error.empty() && response.http_code >= 200 && response.http_code < 300;
+	SegmentedDownload download(*this, request, output_path, segment_count);
+	return download.run();
 }
 
-void NetworkManager::set_common_options(const NetworkRequest& request, char* error_buffer)
+std::future<std::vector<NetworkResponse>> NetworkManager::submit_batch_async(std::span<const NetworkRequest> requests)
 {
-	curl_easy_setopt(this->m_curl.get(), CURLOPT_URL, request.url.c_str());
-	curl_easy_setopt(this->m_curl.get(), CURLOPT_FOLLOWLOCATION, 1L);
-	curl_easy_setopt(this->m_curl.get(), CURLOPT_TIMEOUT, request.timeout_seconds);
-	curl_easy_setopt(this->m_curl.get(), CURLOPT_WRITEFUNCTION, write_callback);
-	curl_easy_setopt(this->m_curl.get(), CURLOPT_ERRORBUFFER, error_buffer);
+	struct BatchState
+	{
+		std::vector<NetworkResponse>			   responses;
+		std::atomic<size_t>						   remaining;
+		std::promise<std::vector<NetworkResponse>> promise;
+	};
 
-	if (!request.user_agent.empty())
+	auto state  = std::make_shared<BatchState>();
+	auto future = state->promise.get_future();
+
+	state->responses.resize(requests.size());
+	state->remaining = requests.size();
+
+	if (requests.empty())
 	{
-		curl_easy_setopt(this->m_curl.get(), CURLOPT_USERAGENT, request.user_agent.c_str());
+		state->promise.set_value({});
+		return future;
 	}
-	if (!request.username.empty() || !request.password.empty())
+
+	for (size_t i = 0; i < requests.size(); ++i)
 	{
-		std::string userpwd = fmt::format("{}:{}", request.username, request.password);
-		curl_easy_setopt(this->m_curl.get(), CURLOPT_USERPWD, userpwd.c_str());
+		NetworkRequest request	   = requests[i];
+		request.wait_for_multiplex = true;
+
+		this->make_request_async(std::move(request), [state, i](NetworkResponse response) {
+			state->responses[i] = std::move(response);
+
+			if (--state->remaining == 0)
+			{
+				state->promise.set_value(std::move(state->responses));
+			}
+		});
 	}
+
+	return future;
 }
 
-size_t NetworkManager::write_callback(void* contents, size_t size, size_t nmemb, void* userp)
+std::future<NetworkResponse> NetworkManager::execute_async(const PreparedRequest& prepared, std::string body)
 {
-	size_t real_size = size * nmemb;
-	if (auto* str = static_cast<std::string*>(userp))
+	auto promise = std::make_shared<std::promise<NetworkResponse>>();
+	auto future	 = promise->get_future();
+
+	this->execute_async(prepared, std::move(body), [promise](NetworkResponse response) {
+		promise->set_value(std::move(response));
+	});
+
+	return future;
+}
+
+NetworkTransferId NetworkManager::execute_async(const PreparedRequest& prepared, std::string body, NetworkCallback callback)
+{
+	if (!prepared.is_valid())
 	{
-		try
-		{
-			str->append(static_cast<char*>(contents), real_size);
-		}
-		catch (const std::bad_alloc& e)
-		{
-			return 0;
+		NetworkResponse response;
+		response.error = "Prepared request is empty.";
+		callback(std::move(response));
+		return this->m_next_transfer_id++;
+	}
+
+	if (body.empty())
+	{
+		return this->execute_async(prepared, std::span<const std::byte>(), std::move(callback));
+	}
+
+	auto response_cache = this->m_response_cache.load();
+
+	if (response_cache && ResponseCache::is_cacheable(prepared.get_request()))
+	{
+		NetworkRequest request = prepared.get_request();
+		request.body		   = std::move(body);
+		return this->make_request_async(std::move(request), std::move(callback));
+	}
+
+	auto transfer	   = std::make_unique<NetworkTransfer>();
+	transfer->prepared = prepared.m_template;
+	transfer->payload  = std::move(body);
+	transfer->body	   = std::as_bytes(std::span(transfer->payload));
+	transfer->callback = std::move(callback);
+
+	return this->submit_transfer(std::move(transfer));
+}
+
+NetworkTransferId NetworkManager::execute_async(const PreparedRequest& prepared, std::span<const std::byte> body_view, NetworkCallback callback)
+{
+	if (!prepared.is_valid())
+	{
+		NetworkResponse response;
+		response.error = "Prepared request is empty.";
+		callback(std::move(response));
+		return this->m_next_transfer_id++;
+	}
+
+	const NetworkRequest& request		 = prepared.get_request();
+	auto				  response_cache = this->m_response_cache.load();
+
+	if (response_cache && body_view.empty() && ResponseCache::is_cacheable(request))
+	{
+		return this->make_request_async(request, std::move(callback));
+	}
+
+	auto transfer	   = std::make_unique<NetworkTransfer>();
+	transfer->prepared = prepared.m_template;
+	transfer->callback = std::move(callback);
+
+	if (!body_view.empty())
+	{
+		transfer->body = body_view;
+	}
+	else
+	{
+		transfer->body = request.body_view.empty() ? std::as_bytes(std::span(request.body)) : request.body_view;
+	}
+
+	return this->submit_transfer(std::move(transfer));
+}
+
+NetworkResponse NetworkManager::execute(const PreparedRequest& prepared, std::string body)
+{
+	if (std::this_thread::get_id() == this->m_event_thread.get_id())
+	{
+		NetworkResponse response;
+		response.error = "Blocking requests are not allowed on the network event loop thread.";
+		SPD_ERROR_CLASS(COMMON::d_settings_group_utils, response.error);
+		return response;
+	}
+
+	return this->execute_async(prepared, std::move(body)).get();
+}
+
+std::vector<NetworkResponse> NetworkManager::submit_batch(std::span<const NetworkRequest> requests)
+{
+	if (std::this_thread::get_id() == this->m_event_thread.get_id())
+	{
+		SPD_ERROR_CLASS(COMMON::d_settings_group_utils, "Blocking requests are not allowed on the network event loop thread.");
+		return std::vector<NetworkResponse>(requests.size());
+	}
+
+	return this->submit_batch_async(requests).get();
+}
+
+bool NetworkManager::upload_file(const std::string& url,
+								 const std::string& file_path,
+								 const std::string& user_agent,
+								 const std::string& username,
+								 const std::string& password)
+{
+	NetworkRequest request;
+	request.method			 = HttpMethod::PUT;
+	request.url				 = url;
+	request.upload_file_path = file_path;
+	request.user_agent		 = user_agent;
+	request.username		 = username;
+	request.password		 = password;
+
+	NetworkResponse response = make_request(request);
+	return response.error.empty() && response.http_code >= 200 && response.http_code < 300;
+}
+
+void NetworkManager::set_pool_options(const ConnectionPoolOptions& options)
+{
+	this->m_connection_pool.set_options(options);
+	this->m_pool_options_changed = true;
+	this->wakeup();
+}
+
+ConnectionPoolStats NetworkManager::get_pool_stats() const
+{
+	return this->m_connection_pool.get_stats();
+}
+
+bool NetworkManager::enable_response_cache(const ResponseCacheOptions& options)
+{
+	auto response_cache = std::make_shared<ResponseCache>();
+
+	if (!response_cache->open(options))
+	{
+		return false;
+	}
+
+	this->m_response_cache.store(std::move(response_cache));
+	return true;
+}
+
+void NetworkManager::disable_response_cache()
+{
+	this->m_response_cache.store(nullptr);
+}
+
+ResponseCacheStats NetworkManager::get_response_cache_stats() const
+{
+	auto response_cache = this->m_response_cache.load();
+	return response_cache ? response_cache->get_stats() : ResponseCacheStats {};
+}
+
+void NetworkManager::set_latency_options(const LatencyTrackerOptions& options)
+{
+	this->m_latency_tracker.set_options(options);
+}
+
+LatencyTrackerOptions NetworkManager::get_latency_options() const
+{
+	return this->m_latency_tracker.get_options();
+}
+
+std::optional<HostLatencyHistograms> NetworkManager::get_latency_histograms(std::string_view host) const
+{
+	return this->m_latency_tracker.get_histograms(host);
+}
+
+std::vector<std::pair<std::string, HostLatencyHistograms>> NetworkManager::get_latency_histograms() const
+{
+	return this->m_latency_tracker.get_histograms();
+}
+
+bool NetworkManager::prepare_transfer(NetworkTransfer& transfer)
+{
+	const RequestTemplate& prepared = *transfer.prepared;
+	const NetworkRequest&  request	= prepared.request;
+
+	transfer.curl = this->m_connection_pool.acquire(prepared.host);
+
+	if (!transfer.curl)
+	{
+		transfer.response.error = "Failed to initialize CURL handle.";
+		SPD_ERROR_CLASS(COMMON::d_settings_group_utils, transfer.response.error);
+		return false;
+	}
+
+	if (is_hedgeable(request) || request.adaptive_timeout)
+	{
+		transfer.latency_profile = this->m_latency_tracker.get_profile(prepared.host);
+	}
+
+	CURL* curl = transfer.curl.get();
+
+	this->set_common_options(transfer);
+
+	switch (request.method)
+	{
+		case HttpMethod::POST: {
+			curl_easy_setopt(curl, CURLOPT_POST, 1L);
+			this->set_request_body(transfer);
+			break;
+		}
+		case HttpMethod::PUT: {
+			curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "PUT");
+
+			if (!request.upload_file_path.empty())
+			{
+				if (!transfer.upload_file.open(request.upload_file_path))
+				{
+					transfer.response.error = fmt::format("Failed to open file for upload: {}", request.upload_file_path);
+					SPD_ERROR_CLASS(COMMON::d_settings_group_utils, transfer.response.error);
+					return false;
+				}
+
+				transfer.upload_file.advise_sequential();
+				transfer.upload_data = transfer.upload_file.data();
+
+				curl_easy_setopt(curl, CURLOPT_UPLOAD, 1L);
+				curl_easy_setopt(curl, CURLOPT_UPLOAD_BUFFERSIZE, UPLOAD_BUFFER_SIZE);
+				curl_easy_setopt(curl, CURLOPT_READFUNCTION, read_callback);
+				curl_easy_setopt(curl, CURLOPT_READDATA, &transfer);
+				curl_easy_setopt(curl, CURLOPT_SEEKFUNCTION, seek_callback);
+				curl_easy_setopt(curl, CURLOPT_SEEKDATA, &transfer);
+				curl_easy_setopt(curl, CURLOPT_INFILESIZE_LARGE, static_cast<curl_off_t>(transfer.upload_data.size()));
+			}
+			else
+			{
+				this->set_request_body(transfer);
+			}
+			break;
+		}
+		case HttpMethod::DELETE: {
+			curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "DELETE");
+			break;
+		}
+		case HttpMethod::HEAD: {
+			curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+			break;
+		}
+		case HttpMethod::GET:
+		default:
+			break;
+	}
+
+	struct curl_slist* header_list = transfer.compressed_body.empty() ? prepared.header_list : prepared.compressed_header_list;
+
+	if (header_list)
+	{
+		curl_easy_setopt(curl, CURLOPT_HTTPHEADER, header_list);
+	}
+
+	if (!request.download_file_path.empty())
+	{
+		transfer.output_file = std::make_unique<std::ofstream>(request.download_file_path, std::ios::binary);
+
+		if (!transfer.output_file->is_open())
+		{
+			transfer.response.error = fmt::format("Failed to open file for writing: {}", request.download_file_path);
+			SPD_ERROR_CLASS(COMMON::d_settings_group_utils, transfer.response.error);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void NetworkManager::set_request_body(NetworkTransfer& transfer)
+{
+	const NetworkRequest& request	  = transfer.prepared->request;
+	CURL*				  curl		  = transfer.curl.get();
+	CompressionStats&	  compression = transfer.response.compression;
+
+	std::span<const std::byte> body = transfer.body;
+	compression.request_bytes		= body.size();
+
+	if (request.compress_body && body.size() >= request.compression_threshold)
+	{
+		auto started	= std::chrono::steady_clock::now();
+		bool compressed = gzip_compress(body, transfer.compressed_body);
+
+		compression.compression_time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started);
+
+		if (compressed && transfer.compressed_body.size() < body.size())
+		{
+			body = std::as_bytes(std::span(transfer.compressed_body));
+		}
+		else
+		{
+			transfer.compressed_body.clear();
+		}
+	}
+
+	compression.request_bytes_encoded = body.size();
+
+	curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(body.size()));
+	curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body.data());
+}
+
+void NetworkManager::set_common_options(NetworkTransfer& transfer)
+{
+	const RequestTemplate& prepared = *transfer.prepared;
+	const NetworkRequest&  request	= prepared.request;
+	CURL*				   curl		= transfer.curl.get();
+
+	curl_easy_setopt(curl, CURLOPT_URL, request.url.c_str());
+	curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+	curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+	curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+	curl_easy_setopt(curl, CURLOPT_TIMEOUT, request.timeout_seconds);
+	curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
+	curl_easy_setopt(curl, CURLOPT_WRITEDATA, &transfer);
+	curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, header_callback);
+	curl_easy_setopt(curl, CURLOPT_HEADERDATA, &transfer);
+	curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, transfer.error_buffer);
+	curl_easy_setopt(curl, CURLOPT_PRIVATE, &transfer);
+
+	if (request.wait_for_multiplex)
+	{
+		curl_easy_setopt(curl, CURLOPT_PIPEWAIT, 1L);
+	}
+	if (!request.range.empty())
+	{
+		curl_easy_setopt(curl, CURLOPT_RANGE, request.range.c_str());
+	}
+	else if (request.decompress_response)
+	{
+		curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "");
+	}
+	if (!request.user_agent.empty())
+	{
+		curl_easy_setopt(curl, CURLOPT_USERAGENT, request.user_agent.c_str());
+	}
+	if (!request.ca_file.empty())
+	{
+		curl_easy_setopt(curl, CURLOPT_CAINFO, request.ca_file.c_str());
+	}
+	if (!prepared.userpwd.empty())
+	{
+		curl_easy_setopt(curl, CURLOPT_USERPWD, prepared.userpwd.c_str());
+	}
+	if (request.adaptive_timeout && transfer.latency_profile)
+	{
+		auto limit = request.timeout_seconds > 0 ? std::chrono::milliseconds(std::chrono::seconds(request.timeout_seconds))
+												 : std::chrono::milliseconds::max();
+
+		if (!is_streaming(request))
+		{
+			auto timeout = std::chrono::ceil<std::chrono::milliseconds>(transfer.latency_profile->total_timeout);
+			curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, static_cast<long>(std::min(timeout, limit).count()));
+		}
+		if (transfer.latency_profile->connect_timeout.count() > 0)
+		{
+			auto timeout = std::chrono::ceil<std::chrono::milliseconds>(transfer.latency_profile->connect_timeout);
+			curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS, static_cast<long>(std::min(timeout, limit).count()));
+		}
+	}
+}
+
+void NetworkManager::finish_transfer(std::unique_ptr<NetworkTransfer> transfer)
+{
+	if (transfer->curl)
+	{
+		curl_easy_getinfo(transfer->curl.get(), CURLINFO_RESPONSE_CODE, &transfer->response.http_code);
+	}
+
+	transfer->upload_file.close();
+	transfer->output_file.reset();
+
+	this->m_connection_pool.release(transfer->prepared->host, std::move(transfer->curl));
+
+	SPD_DEBUG_CLASS(COMMON::d_settings_group_utils,
+					fmt::format("Request to {} completed with HTTP code {}", transfer->prepared->request.url, transfer->response.http_code));
+
+	if (!transfer->callback)
+	{
+		return;
+	}
+
+	try
+	{
+		transfer->callback(std::move(transfer->response));
+	}
+	catch (const std::exception& e)
+	{
+		SPD_ERROR_CLASS(COMMON::d_settings_group_utils, fmt::format("Network callback threw an exception: {}", e.what()));
+	}
+	catch (...)
+	{
+		SPD_ERROR_CLASS(COMMON::d_settings_group_utils, "Network callback threw an unknown exception.");
+	}
+}
+
+void NetworkManager::wakeup()
+{
+#if defined(__linux__)
+	if (this->m_wakeup_fd >= 0)
+	{
+		uint64_t value = 1;
+		[[maybe_unused]] auto written = write(this->m_wakeup_fd, &value, sizeof(value));
+	}
+#else
+	if (this->m_multi)
+	{
+		curl_multi_wakeup(this->m_multi.get());
+	}
+#endif
+}
+
+void NetworkManager::apply_pool_options()
+{
+	ConnectionPoolOptions options = this->m_connection_pool.get_options();
+
+	curl_multi_setopt(this->m_multi.get(), CURLMOPT_MAX_HOST_CONNECTIONS, options.max_connections_per_host);
+	curl_multi_setopt(this->m_multi.get(), CURLMOPT_MAXCONNECTS, options.max_total_connections);
+	curl_multi_setopt(this->m_multi.get(), CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+}
+
+void NetworkManager::attach_pending_transfers()
+{
+	if (this->m_pool_options_changed.exchange(false))
+	{
+		this->apply_pool_options();
+	}
+
+	std::deque<std::unique_ptr<NetworkTransfer>> pending;
+	{
+		std::lock_guard<std::mutex> lock(this->m_network_mutex);
+		pending.swap(this->m_pending_transfers);
+	}
+
+	for (auto& transfer : pending)
+	{
+		CURL*	  curl	 = transfer->curl.get();
+		CURLMcode result = curl_multi_add_handle(this->m_multi.get(), curl);
+
+		if (result != CURLM_OK)
+		{
+			transfer->response.error = fmt::format("curl_multi_add_handle() failed: {}", curl_multi_strerror(result));
+			SPD_ERROR_CLASS(COMMON::d_settings_group_utils, transfer->response.error);
+			this->finish_transfer(std::move(transfer));
+			continue;
+		}
+
+		if (is_hedgeable(transfer->prepared->request) && transfer->latency_profile)
+		{
+			this->m_timers.emplace(std::chrono::steady_clock::now() + transfer->latency_profile->hedge_delay,
+								   [this, transfer_id = transfer->id] {
+									   this->launch_hedged_transfer(transfer_id);
+								   });
+			this->m_hedge_budget = std::min(this->m_hedge_budget + this->m_latency_tracker.get_options().max_hedge_ratio, 1.0);
+		}
+
+		this->m_active_transfer_ids.emplace(transfer->id, curl);
+		this->m_active_transfers.emplace(curl, std::move(transfer));
+	}
+}
+
+void NetworkManager::launch_hedged_transfer(NetworkTransferId transfer_id)
+{
+	auto iterator = this->m_active_transfer_ids.find(transfer_id);
+
+	if (iterator == this->m_active_transfer_ids.end() || this->m_hedge_budget < 1.0)
+	{
+		return;
+	}
+
+	NetworkTransfer& primary = *this->m_active_transfers.at(iterator->second);
+
+	auto hedge			 = std::make_unique<NetworkTransfer>();
+	hedge->id			 = this->m_next_transfer_id++;
+	hedge->prepared		 = primary.prepared;
+	hedge->payload		 = primary.payload;
+	hedge->body			 = primary.payload.empty() ? primary.body : std::as_bytes(std::span(hedge->payload));
+	hedge->hedge_partner = primary.id;
+
+	if (!this->prepare_transfer(*hedge))
+	{
+		this->m_connection_pool.release(hedge->prepared->host, std::move(hedge->curl));
+		return;
+	}
+
+	CURL* curl = hedge->curl.get();
+
+	if (curl_multi_add_handle(this->m_multi.get(), curl) != CURLM_OK)
+	{
+		this->m_connection_pool.release(hedge->prepared->host, std::move(hedge->curl));
+		return;
+	}
+
+	SPD_DEBUG_CLASS(COMMON::d_settings_group_utils,
+					fmt::format("Hedging request to {} after {} us", primary.prepared->request.url, primary.latency_profile->hedge_delay.count()));
+
+	this->m_hedge_budget -= 1.0;
+	primary.hedge_partner = hedge->id;
+
+	this->m_active_transfer_ids.emplace(hedge->id, curl);
+	this->m_active_transfers.emplace(curl, std::move(hedge));
+}
+
+bool NetworkManager::resolve_hedge(std::unique_ptr<NetworkTransfer>& transfer)
+{
+	auto id_iterator = this->m_active_transfer_ids.find(transfer->hedge_partner);
+
+	if (id_iterator == this->m_active_transfer_ids.end())
+	{
+		return true;
+	}
+
+	NetworkTransfer& partner = *this->m_active_transfers.at(id_iterator->second);
+
+	if (!transfer->response.error.empty())
+	{
+		partner.hedge_partner = 0;
+
+		if (!partner.callback)
+		{
+			partner.callback = std::move(transfer->callback);
+		}
+
+		transfer->callback = nullptr;
+		this->finish_transfer(std::move(transfer));
+		return false;
+	}
+
+	auto loser = this->detach_transfer(id_iterator->second);
+
+	if (!transfer->callback)
+	{
+		transfer->callback = std::move(loser->callback);
+	}
+
+	loser->callback		  = nullptr;
+	loser->response.error = "Superseded by a hedged request.";
+	this->finish_transfer(std::move(loser));
+
+	return true;
+}
+
+std::unique_ptr<NetworkTransfer> NetworkManager::detach_transfer(CURL* curl)
+{
+	curl_multi_remove_handle(this->m_multi.get(), curl);
+
+	auto iterator = this->m_active_transfers.find(curl);
+	if (iterator == this->m_active_transfers.end())
+	{
+		return nullptr;
+	}
+
+	auto transfer = std::move(iterator->second);
+	this->m_active_transfers.erase(iterator);
+	this->m_active_transfer_ids.erase(transfer->id);
+
+	return transfer;
+}
+
+void NetworkManager::cancel_requested_transfers()
+{
+	std::vector<std::pair<NetworkTransferId, std::string>> cancel_requests;
+	{
+		std::lock_guard<std::mutex> lock(this->m_network_mutex);
+		cancel_requests.swap(this->m_cancel_requests);
+	}
+
+	for (auto& [transfer_id, reason] : cancel_requests)
+	{
+		auto iterator = this->m_active_transfer_ids.find(transfer_id);
+		if (iterator == this->m_active_transfer_ids.end())
+		{
+			continue;
+		}
+
+		auto transfer			 = this->detach_transfer(iterator->second);
+		transfer->response.error = std::move(reason);
+
+		auto partner_iterator = this->m_active_transfer_ids.find(transfer->hedge_partner);
+		if (partner_iterator != this->m_active_transfer_ids.end())
+		{
+			auto partner = this->detach_transfer(partner_iterator->second);
+
+			if (!transfer->callback)
+			{
+				transfer->callback = std::move(partner->callback);
+			}
+
+			partner->callback = nullptr;
+			this->finish_transfer(std::move(partner));
+		}
+
+		SPD_DEBUG_CLASS(COMMON::d_settings_group_utils,
+						fmt::format("Request to {} cancelled: {}", transfer->prepared->request.url, transfer->response.error));
+		this->finish_transfer(std::move(transfer));
+	}
+}
+
+void NetworkManager::run_timers(std::chrono::steady_clock::time_point now)
+{
+	{
+		std::lock_guard<std::mutex> lock(this->m_network_mutex);
+
+		for (auto& [deadline, task] : this->m_scheduled_timers)
+		{
+			this->m_timers.emplace(deadline, std::move(task));
+		}
+		this->m_scheduled_timers.clear();
+	}
+
+	while (!this->m_timers.empty() && this->m_timers.begin()->first <= now)
+	{
+		auto task = std::move(this->m_timers.begin()->second);
+		this->m_timers.erase(this->m_timers.begin());
+		task();
+	}
+}
+
+void NetworkManager::schedule(std::chrono::steady_clock::time_point deadline, std::function<void()> task)
+{
+	{
+		std::lock_guard<std::mutex> lock(this->m_network_mutex);
+		this->m_scheduled_timers.emplace_back(deadline, std::move(task));
+	}
+
+	this->wakeup();
+}
+
+std::optional<std::chrono::steady_clock::time_point> NetworkManager::get_next_deadline() const
+{
+	std::optional<std::chrono::steady_clock::time_point> deadline = this->m_timer_deadline;
+
+	if (!this->m_timers.empty() && (!deadline || this->m_timers.begin()->first < *deadline))
+	{
+		deadline = this->m_timers.begin()->first;
+	}
+
+	return deadline;
+}
+
+void NetworkManager::resume_paused_transfers()
+{
+	std::vector<NetworkTransferId> resume_requests;
+	{
+		std::lock_guard<std::mutex> lock(this->m_network_mutex);
+		resume_requests.swap(this->m_resume_requests);
+	}
+
+	for (NetworkTransferId transfer_id : resume_requests)
+	{
+		auto iterator = this->m_active_transfer_ids.find(transfer_id);
+		if (iterator != this->m_active_transfer_ids.end())
+		{
+			curl_easy_pause(iterator->second, CURLPAUSE_CONT);
+		}
+	}
+}
+
+void NetworkManager::process_completed_transfers()
+{
+	int		 messages_left = 0;
+	CURLMsg* message	   = nullptr;
+
+	while ((message = curl_multi_info_read(this->m_multi.get(), &messages_left)))
+	{
+		if (message->msg != CURLMSG_DONE)
+		{
+			continue;
+		}
+
+		CURL*	 curl	= message->easy_handle;
+		CURLcode result = message->data.result;
+
+		auto transfer = this->detach_transfer(curl);
+		if (!transfer)
+		{
+			continue;
+		}
+
+		this->m_connection_pool.record_connection(curl);
+
+		transfer->response.timing							  = get_transfer_timing(curl);
+		transfer->response.compression.response_bytes_encoded = transfer->response.timing.bytes_downloaded;
+
+		if (result == CURLE_OK || result == CURLE_OPERATION_TIMEDOUT)
+		{
+			this->m_latency_tracker.record(transfer->prepared->host, transfer->response.timing);
 		}
+
+		if (result != CURLE_OK)
+		{
+			transfer->response.error = fmt::format("Transfer failed: {}",
+												   transfer->error_buffer[0] ? transfer->error_buffer : curl_easy_strerror(result));
+			SPD_ERROR_CLASS(COMMON::d_settings_group_utils, transfer->response.error);
+		}
+
+		if (transfer->hedge_partner != 0 && !this->resolve_hedge(transfer))
+		{
+			continue;
+		}
+
+		this->finish_transfer(std::move(transfer));
+	}
+}
+
+#if defined(__linux__)
+void NetworkManager::event_loop()
+{
+	std::array<epoll_event, 64> events;
+
+	while (this->m_running)
+	{
+		int	 wait_ms  = -1;
+		auto deadline = this->get_next_deadline();
+
+		if (deadline)
+		{
+			auto remaining = std::chrono::ceil<std::chrono::milliseconds>(*deadline - std::chrono::steady_clock::now());
+			wait_ms		   = static_cast<int>(std::max<long long>(remaining.count(), 0));
+		}
+
+		int count = epoll_wait(this->m_epoll_fd, events.data(), static_cast<int>(events.size()), wait_ms);
+
+		if (count < 0 && errno != EINTR)
+		{
+			SPD_ERROR_CLASS(COMMON::d_settings_group_utils, fmt::format("epoll_wait() failed: {}", std::strerror(errno)));
+			break;
+		}
+
+		int running_handles = 0;
+
+		for (int i = 0; i < count; ++i)
+		{
+			if (events[i].data.fd == this->m_wakeup_fd)
+			{
+				uint64_t value = 0;
+				[[maybe_unused]] auto received = read(this->m_wakeup_fd, &value, sizeof(value));
+				continue;
+			}
+
+			int action = 0;
+			action |= (events[i].events & EPOLLIN) ? CURL_CSELECT_IN : 0;
+			action |= (events[i].events & EPOLLOUT) ? CURL_CSELECT_OUT : 0;
+			action |= (events[i].events & (EPOLLERR | EPOLLHUP)) ? CURL_CSELECT_ERR : 0;
+
+			curl_multi_socket_action(this->m_multi.get(), events[i].data.fd, action, &running_handles);
+		}
+
+		if (this->m_timer_deadline && std::chrono::steady_clock::now() >= *this->m_timer_deadline)
+		{
+			this->m_timer_deadline.reset();
+			curl_multi_socket_action(this->m_multi.get(), CURL_SOCKET_TIMEOUT, 0, &running_handles);
+		}
+
+		this->attach_pending_transfers();
+		this->resume_paused_transfers();
+		this->cancel_requested_transfers();
+		this->process_completed_transfers();
+		this->run_timers(std::chrono::steady_clock::now());
 	}
-	else if (auto* stream = static_cast<std::ostream*>(userp))
+}
+
+int NetworkManager::socket_callback(CURL* /*curl*/, curl_socket_t socket, int what, void* userp, void* /*socketp*/)
+{
+	auto* self = static_cast<NetworkManager*>(userp);
+
+	if (what == CURL_POLL_REMOVE)
 	{
-		stream->write(static_cast<char*>(contents), real_size);
+		epoll_ctl(self->m_epoll_fd, EPOLL_CTL_DEL, socket, nullptr);
+		return 0;
 	}
+
+	epoll_event event {};
+	event.data.fd = socket;
+	event.events  = ((what & CURL_POLL_IN) ? uint32_t(EPOLLIN) : 0u) | ((what & CURL_POLL_OUT) ? uint32_t(EPOLLOUT) : 0u);
+
+	if (epoll_ctl(self->m_epoll_fd, EPOLL_CTL_MOD, socket, &event) != 0 && errno == ENOENT)
+	{
+		epoll_ctl(self->m_epoll_fd, EPOLL_CTL_ADD, socket, &event);
+	}
+
+	return 0;
+}
+
+int NetworkManager::timer_callback(CURLM* /*multi*/, long timeout_ms, void* userp)
+{
+	auto* self = static_cast<NetworkManager*>(userp);
+
+	if (timeout_ms < 0)
+	{
+		self->m_timer_deadline.reset();
+	}
+	else
+	{
+		self->m_timer_deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+	}
+
+	return 0;
+}
+#else
+void NetworkManager::event_loop()
+{
+	while (this->m_running)
+	{
+		int running_handles = 0;
+		curl_multi_perform(this->m_multi.get(), &running_handles);
+
+		this->cancel_requested_transfers();
+		this->process_completed_transfers();
+		this->run_timers(std::chrono::steady_clock::now());
+
+		int	 wait_ms  = 1000;
+		auto deadline = this->get_next_deadline();
+
+		if (deadline)
+		{
+			auto remaining = std::chrono::ceil<std::chrono::milliseconds>(*deadline - std::chrono::steady_clock::now());
+			wait_ms		   = static_cast<int>(std::clamp<long long>(remaining.count(), 0, wait_ms));
+		}
+
+		curl_multi_poll(this->m_multi.get(), nullptr, 0, wait_ms, nullptr);
+
+		this->attach_pending_transfers();
+		this->resume_paused_transfers();
+	}
+}
+
+int NetworkManager::socket_callback(CURL*, curl_socket_t, int, void*, void*)
+{
+	return 0;
+}
+
+int NetworkManager::timer_callback(CURLM*, long, void*)
+{
+	return 0;
+}
+#endif
+
+size_t NetworkManager::write_callback(void* contents, size_t size, size_t nmemb, void* userp)
+{
+	size_t real_size = size * nmemb;
+	auto*  transfer	 = static_cast<NetworkTransfer*>(userp);
+
+	const NetworkRequest& request = transfer->prepared->request;
+
+	if (request.chunk_consumer)
+	{
+		switch (request.chunk_consumer(std::as_bytes(std::span(static_cast<char*>(contents), real_size))))
+		{
+			case ChunkResult::CONTINUE:
+				transfer->response.compression.response_bytes += real_size;
+				return real_size;
+			case ChunkResult::PAUSE:
+				return CURL_WRITEFUNC_PAUSE;
+			case ChunkResult::ABORT:
+			default:
+				return 0;
+		}
+	}
+
+	if (transfer->output_file)
+	{
+		transfer->output_file->write(static_cast<char*>(contents), real_size);
+		transfer->response.compression.response_bytes += real_size;
+		return transfer->output_file->good() ? real_size : 0;
+	}
+
+	try
+	{
+		transfer->response.body.append(static_cast<char*>(contents), real_size);
+	}
+	catch (const std::bad_alloc& e)
+	{
+		return 0;
+	}
+
+	transfer->response.compression.response_bytes += real_size;
+	return real_size;
+}
+
+size_t NetworkManager::header_callback(char* buffer, size_t size, size_t nitems, void* userp)
+{
+	size_t			 real_size = size * nitems;
+	auto*			 transfer  = static_cast<NetworkTransfer*>(userp);
+	std::string_view line(buffer, real_size);
+
+	if (line.starts_with("HTTP/"))
+	{
+		transfer->response.headers.clear();
+		return real_size;
+	}
+
+	auto separator = line.find(':');
+	if (separator == std::string_view::npos)
+	{
+		return real_size;
+	}
+
+	auto trim = [](std::string_view value) {
+		auto begin = value.find_first_not_of(" \t\r\n");
+		auto end   = value.find_last_not_of(" \t\r\n");
+		return begin == std::string_view::npos ? std::string_view {} : value.substr(begin, end - begin + 1);
+	};
+
+	try
+	{
+		transfer->response.headers.emplace_back(trim(line.substr(0, separator)), trim(line.substr(separator + 1)));
+	}
+	catch (const std::bad_alloc& e)
+	{
+		return 0;
+	}
+
 	return real_size;
 }
 
-size_t NetworkManager::read_callback(void* ptr, size_t size, size_t nmemb, void* stream)
+size_t NetworkManager::read_callback(void* ptr, size_t size, size_t nmemb, void* userp)
+{
+	auto*  transfer	 = static_cast<NetworkTransfer*>(userp);
+	auto   remaining = transfer->upload_data.subspan(std::min(transfer->upload_offset, transfer->upload_data.size()));
+	size_t length	 = std::min(remaining.size(), size * nmemb);
+
+	std::memcpy(ptr, remaining.data(), length);
+	transfer->upload_offset += length;
+
+	return length;
+}
+
+int NetworkManager::seek_callback(void* userp, curl_off_t offset, int origin)
 {
-	auto* read_stream = static_cast<std::istream*>(stream);
-	read_stream->read(static_cast<char*>(ptr), size * nmemb);
-	return read_stream->gcount();
+	auto* transfer = static_cast<NetworkTransfer*>(userp);
+
+	if (origin != SEEK_SET || offset < 0 || static_cast<size_t>(offset) > transfer->upload_data.size())
+	{
+		return CURL_SEEKFUNC_FAIL;
+	}
+
+	transfer->upload_offset = static_cast<size_t>(offset);
+	return CURL_SEEKFUNC_OK;
 }
 
 } // namespace UTILS
@@ -1,11 +1,30 @@
 #ifndef NETWORK_MANAGER_HPP
 #define NETWORK_MANAGER_HPP
 
+#include "compression.hpp"
+#include "connection_pool.hpp"
+#include "latency_tracker.hpp"
 #include "manager_singleton.hpp"
+#include "mapped_file.hpp"
+#include "task.hpp"
 
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <curl/curl.h>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
 #include <mutex>
+#include <optional>
+#include <span>
+#include <stop_token>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 namespace UTILS
@@ -15,60 +34,138 @@ enum class HttpMethod
 	GET,
 	POST,
 	PUT,
-	DELETE
+	DELETE,
+	HEAD
 };
 
+enum class ChunkResult
+{
+	CONTINUE,
+	PAUSE,
+	ABORT
+};
+
+// Invoked on the network event loop thread for every received chunk. A paused chunk is
+// delivered again once NetworkManager::resume_transfer() is called for the transfer.
+using NetworkChunkConsumer = std::function<ChunkResult(std::span<const std::byte>)>;
+using NetworkTransferId	   = uint64_t;
+
+const std::string& get_default_user_agent();
+
 struct NetworkRequest
 {
 	std::string										 url;
 	HttpMethod										 method			 = HttpMethod::GET;
 	std::vector<std::pair<std::string, std::string>> headers		 = {};
 	std::string										 body			 = {};
-	std::string										 user_agent		 = std::format("Mozilla/5.0 ({}; {}) {}/{}",
-																				   COMMON::d_system_name,
-																				   COMMON::d_system_version,
-																				   COMMON::d_project_name,
-																				   COMMON::d_project_version);
+	std::span<const std::byte>						 body_view		 = {};
+	std::string										 user_agent		 = get_default_user_agent();
 	std::string										 username		 = "";
 	std::string										 password		 = "";
+	std::string										 ca_file		 = ""; // PEM bundle trusted instead of the system one
 	long											 timeout_seconds = 30L;
 
 	std::string download_file_path;
 	std::string upload_file_path;
+	std::string range;
+
+	NetworkChunkConsumer chunk_consumer;
+
+	bool bypass_cache		= false;
+	bool wait_for_multiplex	= false;
+
+	// Only honoured for buffered GET, PUT and DELETE requests once enough latency samples exist for the host.
+	bool hedge			  = false;
+	bool adaptive_timeout = false;
+
+	// Bodies smaller than the threshold, or that do not shrink, are sent uncompressed.
+	bool   decompress_response	 = true;
+	bool   compress_body		 = false;
+	size_t compression_threshold = 1024;
 };
 
 struct NetworkResponse
 {
-	long		http_code = 0;
-	std::string body;
-	std::string error;
+	long											 http_code = 0;
+	std::string										 body;
+	std::string										 error;
+	std::vector<std::pair<std::string, std::string>> headers;
+	TransferTiming									 timing;
+	CompressionStats								 compression;
+
+	std::optional<std::string_view> get_header(std::string_view name) const;
 };
 
-struct CurlDeleter
+// Invoked on the network event loop thread once the transfer has finished.
+using NetworkCallback = std::function<void(NetworkResponse)>;
+
+struct CurlMultiDeleter
 {
-	void operator()(CURL* curl)
+	void operator()(CURLM* multi)
 	{
-		if (curl)
+		if (multi)
 		{
-			curl_easy_cleanup(curl);
+			curl_multi_cleanup(multi);
 		}
 	}
 };
 
+struct NetworkTransfer;
+struct RequestTemplate;
+struct ResponseCacheOptions;
+struct ResponseCacheStats;
+class ResponseCache;
+
+// Builds the header list, credentials and user agent of a request once so that it can be executed
+// repeatedly with only the body changing. Copies share the same immutable template.
+class PreparedRequest
+{
+	friend class NetworkManager;
+
+public:
+	PreparedRequest() = default;
+	explicit PreparedRequest(NetworkRequest request);
+
+	bool				  is_valid() const;
+	const NetworkRequest& get_request() const;
+
+private:
+	std::shared_ptr<const RequestTemplate> m_template;
+};
+
 class NetworkManager : public UTILS::ManagerSingleton<NetworkManager>
 {
 	friend class ManagerSingleton<NetworkManager>;
 
 private:
-	NetworkManager() = default;
+	NetworkManager();
 
 	void initialize() override;
-	void cleanup();
 
 public:
 	std::string_view get_manager_name() const override;
 
 	~NetworkManager();
+	void shutdown() override;
+
+	std::future<NetworkResponse> make_request_async(NetworkRequest request);
+	NetworkTransferId			 make_request_async(NetworkRequest request, NetworkCallback callback);
+	void						 resume_transfer(NetworkTransferId transfer_id);
+	void						 cancel_transfer(NetworkTransferId transfer_id, std::string reason = "Transfer cancelled.");
+
+	// Awaiting coroutines are resumed on the network event loop thread and must not block it.
+	Task<NetworkResponse> request(NetworkRequest request, std::stop_token stop_token = {});
+	Task<NetworkResponse> request(NetworkRequest request, std::chrono::milliseconds timeout, std::stop_token stop_token = {});
+	Task<bool>			  sleep_for(std::chrono::milliseconds duration, std::stop_token stop_token = {});
+
+	// An empty body sends the body of the prepared request, if any. A body view must outlive the transfer.
+	std::future<NetworkResponse> execute_async(const PreparedRequest& prepared, std::string body = {});
+	NetworkTransferId			 execute_async(const PreparedRequest& prepared, std::string body, NetworkCallback callback);
+	NetworkTransferId			 execute_async(const PreparedRequest& prepared, std::span<const std::byte> body_view, NetworkCallback callback);
+	NetworkResponse				 execute(const PreparedRequest& prepared, std::string body = {});
+
+	std::future<std::vector<NetworkResponse>> submit_batch_async(std::span<const NetworkRequest> requests);
+	std::vector<NetworkResponse>			  submit_batch(std::span<const NetworkRequest> requests);
 
 	NetworkResponse make_request(const NetworkRequest& request);
 	NetworkResponse make_request(HttpMethod												 method,
@@ -88,18 +185,84 @@ public:
 								const std::string& user_agent = "",
 								const std::string& username	  = "",
 								const std::string& password	  = "");
+	bool			download_file_segmented(const std::string& url,
+											const std::string& output_path,
+											size_t			   segment_count = 4,
+											const std::string& user_agent	 = "",
+											const std::string& username		 = "",
+											const std::string& password		 = "");
+
+	void				set_pool_options(const ConnectionPoolOptions& options);
+	ConnectionPoolStats get_pool_stats() const;
+
+	bool			   enable_response_cache(const ResponseCacheOptions& options);
+	void			   disable_response_cache();
+	ResponseCacheStats get_response_cache_stats() const;
+
+	void													   set_latency_options(const LatencyTrackerOptions& options);
+	LatencyTrackerOptions									   get_latency_options() const;
+	std::optional<HostLatencyHistograms>					   get_latency_histograms(std::string_view host) const;
+	std::vector<std::pair<std::string, HostLatencyHistograms>> get_latency_histograms() const;
 
 private:
 	static size_t write_callback(void* contents, size_t size, size_t nmemb, void* userp);
-	static size_t read_callback(void* ptr, size_t size, size_t nmemb, void* stream);
+	static size_t read_callback(void* ptr, size_t size, size_t nmemb, void* userp);
+	static int	  seek_callback(void* userp, curl_off_t offset, int origin);
+	static size_t header_callback(char* buffer, size_t size, size_t nitems, void* userp);
+	static int	  socket_callback(CURL* curl, curl_socket_t socket, int what, void* userp, void* socketp);
+	static int	  timer_callback(CURLM* multi, long timeout_ms, void* userp);
 
-	void set_common_options(const NetworkRequest& request, char* error_buffer);
+	NetworkTransferId				 submit_transfer(NetworkRequest request, NetworkCallback callback);
+	NetworkTransferId				 submit_transfer(std::unique_ptr<NetworkTransfer> transfer);
+	bool							 prepare_transfer(NetworkTransfer& transfer);
+	void							 set_common_options(NetworkTransfer& transfer);
+	void							 set_request_body(NetworkTransfer& transfer);
+	void							 finish_transfer(std::unique_ptr<NetworkTransfer> transfer);
+	std::unique_ptr<NetworkTransfer> detach_transfer(CURL* curl);
+	bool							 resolve_hedge(std::unique_ptr<NetworkTransfer>& transfer);
+
+	void event_loop();
+	void wakeup();
+	void apply_pool_options();
+	void attach_pending_transfers();
+	void resume_paused_transfers();
+	void cancel_requested_transfers();
+	void process_completed_transfers();
+	void launch_hedged_transfer(NetworkTransferId transfer_id);
+	void run_timers(std::chrono::steady_clock::time_point now);
+	void schedule(std::chrono::steady_clock::time_point deadline, std::function<void()> task);
+
+	std::optional<std::chrono::steady_clock::time_point> get_next_deadline() const;
 
 private:
-	std::unique_ptr<CURL, CurlDeleter> m_curl;
+	std::unique_ptr<CURLM, CurlMultiDeleter> m_multi;
+	ConnectionPool							 m_connection_pool;
+	std::atomic<bool>						 m_pool_options_changed = false;
+
+	std::atomic<std::shared_ptr<ResponseCache>> m_response_cache;
+
+	std::thread		  m_event_thread;
+	std::atomic<bool> m_running = false;
+
+	int m_epoll_fd	= -1;
+	int m_wakeup_fd = -1;
+
+	std::optional<std::chrono::steady_clock::time_point> m_timer_deadline;
+
+	std::unordered_map<CURL*, std::unique_ptr<NetworkTransfer>>	m_active_transfers;
+	std::unordered_map<NetworkTransferId, CURL*>				m_active_transfer_ids;
+	std::atomic<NetworkTransferId>								m_next_transfer_id = 1;
+
+	LatencyTracker																m_latency_tracker;
+	std::multimap<std::chrono::steady_clock::time_point, std::function<void()>>	m_timers;
+	double																		m_hedge_budget = 0.0;
 
 protected:
-	static std::mutex m_network_mutex;
+	std::mutex																			 m_network_mutex;
+	std::deque<std::unique_ptr<NetworkTransfer>>										 m_pending_transfers;
+	std::vector<NetworkTransferId>														 m_resume_requests;
+	std::vector<std::pair<NetworkTransferId, std::string>>								 m_cancel_requests;
+	std::vector<std::pair<std::chrono::steady_clock::time_point, std::function<void()>>> m_scheduled_timers;
 };
 } // namespace UTILS
 
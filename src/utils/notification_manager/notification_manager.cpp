@@ -1,19 +1,190 @@
 #include "notification_manager.hpp"
 
 #include "network_manager.hpp"
+#include "notification_outbox.hpp"
 #include "settings_manager.hpp"
 
+#include <algorithm>
+#include <optional>
+
+namespace
+{
+// Read for every notification sent.
+constexpr UTILS::SettingKey<bool, "notifications.enabled">		   NOTIFICATIONS_ENABLED;
+constexpr UTILS::SettingKey<std::string, "notifications.uri">	   NOTIFICATIONS_URI;
+constexpr UTILS::SettingKey<std::string, "notifications.username"> NOTIFICATIONS_USERNAME;
+constexpr UTILS::SettingKey<std::string, "notifications.password"> NOTIFICATIONS_PASSWORD;
+
+constexpr UTILS::SettingKey<int64_t, "notifications.rate_per_minute"> NOTIFICATIONS_RATE;
+constexpr UTILS::SettingKey<int64_t, "notifications.rate_burst">	  NOTIFICATIONS_RATE_BURST;
+
+UTILS::NotificationOverflowPolicy parse_overflow_policy(std::string_view policy)
+{
+	if (policy == "drop_oldest")
+	{
+		return UTILS::NotificationOverflowPolicy::DROP_OLDEST;
+	}
+	if (policy == "drop_newest")
+	{
+		return UTILS::NotificationOverflowPolicy::DROP_NEWEST;
+	}
+	if (policy != "block")
+	{
+		SPD_WARN_CLASS(COMMON::d_settings_group_utils, fmt::format("Unknown notification overflow policy '{}', using 'block'.", policy));
+	}
+	return UTILS::NotificationOverflowPolicy::BLOCK;
+}
+
+std::string get_coalescing_key(const UTILS::NotificationMessage& notification)
+{
+	std::string key = notification.topic;
+
+	for (const auto& tag : notification.tags)
+	{
+		key += '\n';
+		key += tag;
+	}
+
+	return key;
+}
+
+std::string_view get_priority_name(UTILS::NotificationPriority priority)
+{
+	switch (priority)
+	{
+		case UTILS::NotificationPriority::MIN:
+			return "min";
+		case UTILS::NotificationPriority::LOW:
+			return "low";
+		case UTILS::NotificationPriority::HIGH:
+			return "high";
+		case UTILS::NotificationPriority::MAX:
+			return "max";
+		default:
+			return "default";
+	}
+}
+
+// FNV-1a over the fields that make two notifications identical to the reader.
+uint64_t get_content_hash(const UTILS::NotificationMessage& notification)
+{
+	uint64_t hash = 14695981039346656037ULL;
+
+	auto append = [&hash](std::string_view field) {
+		for (unsigned char character : field)
+		{
+			hash ^= character;
+			hash *= 1099511628211ULL;
+		}
+		hash ^= 0xFF;
+		hash *= 1099511628211ULL;
+	};
+
+	append(notification.topic);
+	append(notification.title);
+	append(notification.message);
+	for (const auto& tag : notification.tags)
+	{
+		append(tag);
+	}
+
+	return hash;
+}
+} // anonymous namespace
+
 namespace UTILS
 {
 std::mutex NotificationManager::m_notification_mutex;
 
+NotificationManager::NotificationManager() = default;
+
 std::string_view NotificationManager::get_manager_name() const
 {
 	return "Notification Manager";
 }
 
 void NotificationManager::initialize()
-{}
+{
+	auto settings_manager = UTILS::SettingsManager::instance();
+
+	auto worker_count	= std::max<int64_t>(settings_manager->get_setting<int64_t>("notifications.workers", 2), 1);
+	auto max_in_flight	= std::max<int64_t>(settings_manager->get_setting<int64_t>("notifications.max_in_flight", 16), 1);
+	auto queue_capacity = std::max<int64_t>(settings_manager->get_setting<int64_t>("notifications.queue_capacity", 1024), 1);
+
+	auto coalesce_window	= std::max<int64_t>(settings_manager->get_setting<int64_t>("notifications.coalesce_window_ms", 5000), 0);
+	auto coalesce_threshold = std::max<int64_t>(settings_manager->get_setting<int64_t>("notifications.coalesce_max_count", 100), 1);
+
+	auto dedup_window = std::max<int64_t>(settings_manager->get_setting<int64_t>("notifications.dedup_window_ms", 10000), 0);
+
+	this->m_overflow_policy	   = parse_overflow_policy(settings_manager->get_setting<std::string>("notifications.overflow_policy", "block"));
+	this->m_queue			   = std::make_unique<BoundedQueue<QueuedNotification>>(static_cast<size_t>(queue_capacity));
+	this->m_max_in_flight	   = static_cast<uint64_t>(max_in_flight);
+	this->m_coalesce_window	   = std::chrono::milliseconds(coalesce_window);
+	this->m_coalesce_threshold = static_cast<uint64_t>(coalesce_threshold);
+	this->m_running			   = true;
+
+	if (dedup_window > 0)
+	{
+		this->m_duplicate_filter = std::make_unique<DuplicateFilter>(std::chrono::milliseconds(dedup_window));
+	}
+
+	// Limits are in notifications per minute, a topic without its own entry under notifications.rate uses rate_per_minute.
+	this->m_topic_limiter = std::make_unique<RateLimiter>([settings_manager](std::string_view topic) {
+		auto rate  = settings_manager->get_setting(NOTIFICATIONS_RATE, 60);
+		auto limit = settings_manager->get_setting<int64_t>(fmt::format("notifications.rate.{}", topic), rate);
+		auto burst = std::max<int64_t>(settings_manager->get_setting(NOTIFICATIONS_RATE_BURST, 10), 1);
+		return RateLimit {static_cast<double>(limit) / 60.0, static_cast<double>(burst)};
+	});
+
+	this->m_priority_limiter = std::make_unique<RateLimiter>([settings_manager](std::string_view priority) {
+		auto limit = settings_manager->get_setting<int64_t>(fmt::format("notifications.priority_rate.{}", priority), 0);
+		auto burst = std::max<int64_t>(settings_manager->get_setting(NOTIFICATIONS_RATE_BURST, 10), 1);
+		return RateLimit {static_cast<double>(limit) / 60.0, static_cast<double>(burst)};
+	});
+
+	// Rate limits follow settings reloads, buckets are rebuilt with the new limits on their next use.
+	this->m_settings_manager	  = settings_manager;
+	this->m_settings_subscription = settings_manager->subscribe("notifications", [this](const std::vector<std::string>& changed_paths) {
+		for (const auto& path : changed_paths)
+		{
+			if (path.starts_with("notifications.rate") || path.starts_with("notifications.priority_rate"))
+			{
+				this->m_topic_limiter->reset();
+				this->m_priority_limiter->reset();
+				return;
+			}
+		}
+	});
+
+	for (int64_t i = 0; i < worker_count; ++i)
+	{
+		this->m_workers.emplace_back(&NotificationManager::dispatch_worker, this);
+	}
+
+	if (settings_manager->get_setting<bool>("notifications.outbox_enabled", false))
+	{
+		NotificationOutboxOptions options;
+		options.path		 = settings_manager->get_setting<std::string>("notifications.outbox_path", options.path.string());
+		options.max_attempts = static_cast<uint32_t>(
+			std::max<int64_t>(settings_manager->get_setting<int64_t>("notifications.outbox_max_attempts", options.max_attempts), 1));
+
+		this->m_outbox = std::make_unique<NotificationOutbox>();
+
+		bool opened = this->m_outbox->open(options, [this](uint64_t id, NotificationMessage notification) {
+			this->dispatch(QueuedNotification {std::move(notification), std::chrono::steady_clock::now(), id});
+		});
+
+		if (!opened)
+		{
+			this->m_outbox.reset();
+		}
+	}
+
+	if (this->m_coalesce_window.count() > 0)
+	{
+		this->m_coalesce_thread = std::thread(&NotificationManager::coalesce_worker, this);
+	}
+}
 
 NotificationManager::~NotificationManager()
 {
@@ -22,11 +193,77 @@ NotificationManager::~NotificationManager()
 
 void NotificationManager::shutdown()
 {
-	for (auto& fut : this->m_futures)
+	if (!this->m_running.exchange(false))
 	{
-		fut.wait();
+		return;
+	}
+
+	this->m_settings_manager->unsubscribe(this->m_settings_subscription);
+
+	{
+		std::lock_guard<std::mutex> lock(this->m_coalesce_mutex);
+	}
+	this->m_coalesce_condition.notify_all();
+
+	if (this->m_coalesce_thread.joinable())
+	{
+		this->m_coalesce_thread.join();
+	}
+
+	for (auto& digest : this->collect_digests(std::chrono::steady_clock::time_point::max()))
+	{
+		this->enqueue(std::move(digest));
+	}
+
+	// Whatever the outbox has not handed out yet stays stored and is replayed on the next start.
+	if (this->m_outbox)
+	{
+		this->m_outbox->close();
+	}
+
+	this->m_queued_signal.fetch_add(1, std::memory_order_release);
+	this->m_queued_signal.notify_all();
+	this->m_space_signal.fetch_add(1, std::memory_order_release);
+	this->m_space_signal.notify_all();
+
+	for (auto& worker : this->m_workers)
+	{
+		if (worker.joinable())
+		{
+			worker.join();
+		}
+	}
+	this->m_workers.clear();
+
+	// Deliveries still waiting on the server report back to the outbox, which is only flushed below.
+	uint64_t in_flight = this->m_in_flight.load(std::memory_order_acquire);
+	while (in_flight != 0)
+	{
+		this->m_in_flight.wait(in_flight, std::memory_order_acquire);
+		in_flight = this->m_in_flight.load(std::memory_order_acquire);
+	}
+
+	// Producers that were blocked on a full queue may have pushed after the workers drained it.
+	QueuedNotification queued;
+	while (this->m_queue->try_pop(queued))
+	{
+		this->m_space_signal.fetch_add(1, std::memory_order_release);
+		this->m_space_signal.notify_all();
+
+		if (queued.outbox_id != 0)
+		{
+			continue;
+		}
+
+		++this->m_dropped;
+		SPD_WARN_CLASS(COMMON::d_settings_group_utils,
+					   fmt::format("Dropping notification '{}', notification manager is shutting down.", queued.notification.title));
+	}
+
+	if (this->m_outbox)
+	{
+		this->m_outbox->close();
 	}
-	m_futures.clear();
 }
 
 void NotificationManager::send_notification(std::string_view				topic,
@@ -51,72 +288,448 @@ void NotificationManager::send_notification(std::string_view				topic,
 
 void NotificationManager::send_notification(const NotificationMessage& notification)
 {
-	std::lock_guard<std::mutex> lock(this->m_notification_mutex);
+	if (!this->m_running)
+	{
+		++this->m_dropped;
+		SPD_WARN_CLASS(COMMON::d_settings_group_utils, "Unable to send notification, notification manager is shut down.");
+		return;
+	}
+
+	// Repeats are folded into digests first, so they are counted there instead of being suppressed.
+	if (this->m_coalesce_window.count() > 0 && this->coalesce(notification))
+	{
+		return;
+	}
+
+	if (this->m_duplicate_filter && this->m_duplicate_filter->is_duplicate(get_content_hash(notification)))
+	{
+		++this->m_suppressed;
+		SPD_DEBUG_CLASS(COMMON::d_settings_group_utils, fmt::format("Suppressing duplicate notification '{}'.", notification.title));
+		return;
+	}
+
+	// Digests are not limited, they already stand in for the notifications that were held back.
+	if (!this->m_priority_limiter->try_acquire(get_priority_name(notification.priority)) ||
+		!this->m_topic_limiter->try_acquire(notification.topic))
+	{
+		++this->m_rate_limited;
+		SPD_DEBUG_CLASS(COMMON::d_settings_group_utils,
+						fmt::format("Rate limit reached for topic '{}', dropping notification '{}'.", notification.topic, notification.title));
+		return;
+	}
+
+	this->enqueue(notification);
+}
+
+// The first message of a quiet group goes out immediately. Repeats within the window are folded into
+// a digest that is sent when the window closes or the group reaches the count threshold.
+bool NotificationManager::coalesce(const NotificationMessage& notification)
+{
+	auto now = std::chrono::steady_clock::now();
+	auto key = get_coalescing_key(notification);
 
-	m_futures.push_back(std::async(std::launch::async, [notification] {
-		auto settings_manager = UTILS::SettingsManager::instance();
-		if (settings_manager->get_setting<std::string>("notifications.enabled", "false").compare("false"))
+	std::optional<NotificationMessage> digest;
+	{
+		std::lock_guard<std::mutex> lock(this->m_coalesce_mutex);
+
+		auto [iterator, inserted] = this->m_coalesce_groups.try_emplace(std::move(key));
+		CoalescedGroup& group	  = iterator->second;
+
+		// The digest of the first window quotes the message that went out immediately, later windows
+		// start with their first repeat.
+		if (inserted)
+		{
+			group.first		 = notification;
+			group.first_seen = now;
+			group.window_end = now + this->m_coalesce_window;
+			this->m_coalesce_condition.notify_one();
+			return false;
+		}
+
+		if (group.first_seen == std::chrono::steady_clock::time_point {})
 		{
-			SPD_DEBUG_CLASS(COMMON::d_settings_group_utils, "Unable to send notification, notifications are disabled.");
-			return;
+			group.first		 = notification;
+			group.first_seen = now;
 		}
 
-		auto notifications_uri = settings_manager->get_setting<std::string>("notifications.uri", "");
-		if (notifications_uri.empty())
+		if (group.count == 0)
 		{
-			SPD_DEBUG_CLASS(COMMON::d_settings_group_utils, "Unable to send notification, notifications server is empty.");
-			return;
+			group.priority = notification.priority;
 		}
 
-		auto network_manager = UTILS::NetworkManager::instance();
+		group.last		= notification;
+		group.last_seen = now;
+		group.priority	= std::max(group.priority, notification.priority);
+		++group.count;
+		++this->m_coalesced;
 
-		std::string tags;
-		for (const auto& tag : notification.tags)
+		if (group.count >= this->m_coalesce_threshold)
 		{
-			tags += tag + ",";
+			digest			 = make_digest(group);
+			group.count		 = 0;
+			group.first_seen = {};
+			group.window_end = now + this->m_coalesce_window;
 		}
-		if (!tags.empty())
+	}
+
+	if (digest)
+	{
+		this->enqueue(std::move(*digest));
+	}
+
+	return true;
+}
+
+NotificationMessage NotificationManager::make_digest(const CoalescedGroup& group)
+{
+	if (group.count == 1)
+	{
+		return group.last;
+	}
+
+	auto elapsed = std::chrono::duration<double>(group.last_seen - group.first_seen);
+
+	NotificationMessage digest = group.last;
+	digest.title			   = fmt::format("{} ({} occurrences)", group.first.title, group.count);
+	digest.message			   = fmt::format("{} similar notifications in {:.1f}s.\nFirst: {}\nLast: {}",
+											 group.count,
+											 elapsed.count(),
+											 group.first.message,
+											 group.last.message);
+	digest.priority			   = group.priority;
+	digest.enable_markdown	   = false;
+
+	return digest;
+}
+
+std::vector<NotificationMessage> NotificationManager::collect_digests(std::chrono::steady_clock::time_point now)
+{
+	std::vector<NotificationMessage> digests;
+
+	std::lock_guard<std::mutex> lock(this->m_coalesce_mutex);
+
+	for (auto iterator = this->m_coalesce_groups.begin(); iterator != this->m_coalesce_groups.end();)
+	{
+		CoalescedGroup& group = iterator->second;
+
+		if (group.window_end > now)
 		{
-			tags.pop_back();
+			++iterator;
+			continue;
 		}
 
-		std::string actions;
-		for (const auto& action : notification.actions)
+		if (group.count == 0)
 		{
-			actions += action + ";";
+			iterator = this->m_coalesce_groups.erase(iterator);
+			continue;
 		}
-		if (!actions.empty())
+
+		digests.push_back(make_digest(group));
+
+		if (now == std::chrono::steady_clock::time_point::max())
 		{
-			actions.pop_back();
+			iterator = this->m_coalesce_groups.erase(iterator);
+			continue;
 		}
 
-		std::vector<std::pair<std::string, std::string>> headers;
-		headers.push_back({"Title", std::string(notification.title)});
-		headers.push_back({"Priority", std::to_string(static_cast<int>(notification.priority))});
-		headers.push_back({"Tags", tags});
-		headers.push_back({"Markdown", (notification.enable_markdown ? "true" : "false")});
-		headers.push_back({"Delay", std::string(notification.schedule)});
-		headers.push_back({"Click", std::string(notification.click_action)});
-		headers.push_back({"Attach", std::string(notification.attachment_url)});
-		headers.push_back({"Email", std::string(notification.email_recipient)});
-		headers.push_back({"Actions", actions});
+		group.count		 = 0;
+		group.first_seen = {};
+		group.window_end = now + this->m_coalesce_window;
+		++iterator;
+	}
+
+	return digests;
+}
+
+void NotificationManager::coalesce_worker()
+{
+	while (this->m_running)
+	{
+		{
+			std::unique_lock<std::mutex> lock(this->m_coalesce_mutex);
 
-		NetworkRequest request;
-		request.method	= HttpMethod::POST;
-		request.url		= notifications_uri;
-		request.headers = headers;
-		request.body	= notification.message;
+			auto deadline = std::chrono::steady_clock::time_point::max();
+			for (const auto& [key, group] : this->m_coalesce_groups)
+			{
+				deadline = std::min(deadline, group.window_end);
+			}
 
-		request.username = settings_manager->get_setting<std::string>("notifications.username", "");
-		request.password = settings_manager->get_setting<std::string>("notifications.password", "");
+			if (this->m_running)
+			{
+				if (deadline == std::chrono::steady_clock::time_point::max())
+				{
+					this->m_coalesce_condition.wait(lock);
+				}
+				else
+				{
+					this->m_coalesce_condition.wait_until(lock, deadline);
+				}
+			}
+		}
 
-		auto response = network_manager->make_request(request);
-		if (!response.error.empty())
+		for (auto& digest : this->collect_digests(std::chrono::steady_clock::now()))
 		{
-			SPD_DEBUG_CLASS(COMMON::d_settings_group_utils,
-							fmt::format("Unable to send notification. Response code {}: {}", response.http_code, response.error));
+			this->enqueue(std::move(digest));
+		}
+	}
+}
+
+void NotificationManager::enqueue(NotificationMessage notification)
+{
+	if (this->m_outbox)
+	{
+		this->m_outbox->stage(std::move(notification));
+		return;
+	}
+
+	this->dispatch(QueuedNotification {std::move(notification), std::chrono::steady_clock::now()});
+}
+
+void NotificationManager::dispatch(QueuedNotification queued)
+{
+	for (;;)
+	{
+		uint64_t signal = this->m_space_signal.load(std::memory_order_acquire);
+
+		if (this->m_queue->try_push(std::move(queued)))
+		{
+			break;
+		}
+
+		switch (this->m_overflow_policy)
+		{
+			case NotificationOverflowPolicy::DROP_NEWEST: {
+				this->drop_queued(queued);
+				return;
+			}
+			case NotificationOverflowPolicy::DROP_OLDEST: {
+				QueuedNotification oldest;
+				if (this->m_queue->try_pop(oldest))
+				{
+					this->drop_queued(oldest);
+				}
+				break;
+			}
+			case NotificationOverflowPolicy::BLOCK:
+			default:
+				// Nobody drains the queue once the workers are gone, shutdown bumps the signal to wake waiting producers.
+				if (!this->m_running)
+				{
+					this->drop_queued(queued);
+					return;
+				}
+				this->m_space_signal.wait(signal, std::memory_order_acquire);
+				break;
+		}
+	}
+
+	++this->m_enqueued;
+	this->m_queued_signal.fetch_add(1, std::memory_order_release);
+	this->m_queued_signal.notify_one();
+}
+
+// Durable notifications stay in the outbox and are handed out again after the retry delay.
+void NotificationManager::drop_queued(const QueuedNotification& queued)
+{
+	if (queued.outbox_id != 0)
+	{
+		++this->m_deferred;
+		SPD_DEBUG_CLASS(COMMON::d_settings_group_utils,
+						fmt::format("Notification queue is full, deferring notification '{}'.", queued.notification.title));
+		this->m_outbox->retry(queued.outbox_id);
+		return;
+	}
+
+	++this->m_dropped;
+	SPD_WARN_CLASS(COMMON::d_settings_group_utils,
+				   fmt::format("Notification queue is full, dropping notification '{}'.", queued.notification.title));
+}
+
+// Workers only pop and start deliveries, the deliveries themselves run concurrently on the network event loop
+// up to notifications.max_in_flight at a time.
+void NotificationManager::dispatch_worker()
+{
+	QueuedNotification queued;
+
+	for (;;)
+	{
+		uint64_t in_flight = this->m_in_flight.load(std::memory_order_acquire);
+
+		if (in_flight >= this->m_max_in_flight)
+		{
+			this->m_in_flight.wait(in_flight, std::memory_order_acquire);
+			continue;
+		}
+
+		if (!this->m_in_flight.compare_exchange_weak(in_flight, in_flight + 1, std::memory_order_acq_rel))
+		{
+			continue;
+		}
+
+		uint64_t signal = this->m_queued_signal.load(std::memory_order_acquire);
+
+		if (!this->m_queue->try_pop(queued))
+		{
+			this->m_in_flight.fetch_sub(1, std::memory_order_release);
+			this->m_in_flight.notify_all();
+
+			if (!this->m_running)
+			{
+				return;
+			}
+
+			this->m_queued_signal.wait(signal, std::memory_order_acquire);
+			continue;
 		}
-	}));
+
+		this->m_space_signal.fetch_add(1, std::memory_order_release);
+		this->m_space_signal.notify_one();
+
+		spawn(this->deliver_queued(std::move(queued)));
+	}
+}
+
+// Owns one of the in-flight slots taken by dispatch_worker and releases it once the outcome is recorded.
+Task<void> NotificationManager::deliver_queued(QueuedNotification queued)
+{
+	auto result	 = co_await this->deliver_notification(std::move(queued.notification));
+	auto latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - queued.enqueued);
+
+	++(result == DeliveryResult::DELIVERED ? this->m_delivered : this->m_failed);
+
+	if (queued.outbox_id != 0 && result == DeliveryResult::FAILED)
+	{
+		this->m_outbox->retry(queued.outbox_id);
+	}
+	else if (queued.outbox_id != 0)
+	{
+		this->m_outbox->complete(queued.outbox_id);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(this->m_notification_mutex);
+		this->m_delivery_latency.record(latency);
+	}
+
+	this->m_in_flight.fetch_sub(1, std::memory_order_release);
+	this->m_in_flight.notify_all();
+}
+
+NotificationQueueStats NotificationManager::get_queue_stats() const
+{
+	NotificationQueueStats stats;
+	stats.depth		   = this->m_queue ? this->m_queue->size() : 0;
+	stats.capacity	   = this->m_queue ? this->m_queue->capacity() : 0;
+	stats.enqueued	   = this->m_enqueued;
+	stats.delivered	   = this->m_delivered;
+	stats.failed	   = this->m_failed;
+	stats.dropped	   = this->m_dropped;
+	stats.deferred	   = this->m_deferred;
+	stats.coalesced	   = this->m_coalesced;
+	stats.suppressed   = this->m_suppressed;
+	stats.rate_limited = this->m_rate_limited;
+
+	std::lock_guard<std::mutex> lock(this->m_notification_mutex);
+	stats.delivery_latency = this->m_delivery_latency;
+
+	return stats;
+}
+
+NotificationOutboxStats NotificationManager::get_outbox_stats() const
+{
+	return this->m_outbox ? this->m_outbox->get_stats() : NotificationOutboxStats {};
+}
+
+Task<bool> NotificationManager::send_notification_async(NotificationMessage notification)
+{
+	co_return co_await this->deliver_notification(std::move(notification)) == DeliveryResult::DELIVERED;
+}
+
+Task<NotificationManager::DeliveryResult> NotificationManager::deliver_notification(NotificationMessage notification)
+{
+	auto& settings_manager = UTILS::SettingsManager::instance_ref();
+	if (!settings_manager.get_setting(NOTIFICATIONS_ENABLED, false))
+	{
+		SPD_DEBUG_CLASS(COMMON::d_settings_group_utils, "Unable to send notification, notifications are disabled.");
+		co_return DeliveryResult::REJECTED;
+	}
+
+	auto notifications_uri = settings_manager.get_setting(NOTIFICATIONS_URI, "");
+	if (notifications_uri.empty())
+	{
+		SPD_DEBUG_CLASS(COMMON::d_settings_group_utils, "Unable to send notification, notifications server is empty.");
+		co_return DeliveryResult::REJECTED;
+	}
+
+	auto& network_manager = UTILS::NetworkManager::instance_ref();
+
+	std::string tags;
+	for (const auto& tag : notification.tags)
+	{
+		tags += tag + ",";
+	}
+	if (!tags.empty())
+	{
+		tags.pop_back();
+	}
+
+	std::string actions;
+	for (const auto& action : notification.actions)
+	{
+		actions += action + ";";
+	}
+	if (!actions.empty())
+	{
+		actions.pop_back();
+	}
+
+	std::vector<std::pair<std::string, std::string>> headers;
+	headers.push_back({"Title", std::string(notification.title)});
+	headers.push_back({"Priority", std::to_string(static_cast<int>(notification.priority))});
+	headers.push_back({"Tags", tags});
+	headers.push_back({"Markdown", (notification.enable_markdown ? "true" : "false")});
+	headers.push_back({"Delay", std::string(notification.schedule)});
+	headers.push_back({"Click", std::string(notification.click_action)});
+	headers.push_back({"Attach", std::string(notification.attachment_url)});
+	headers.push_back({"Email", std::string(notification.email_recipient)});
+	headers.push_back({"Actions", actions});
+
+	if (!notification.idempotency_key.empty())
+	{
+		headers.push_back({"Idempotency-Key", notification.idempotency_key});
+	}
+
+	NetworkRequest request;
+	request.method	= HttpMethod::POST;
+	request.url		= notifications_uri;
+	request.headers = headers;
+	request.body	= notification.message;
+
+	request.username = settings_manager.get_setting(NOTIFICATIONS_USERNAME, "");
+	request.password = settings_manager.get_setting(NOTIFICATIONS_PASSWORD, "");
+
+	auto response = co_await network_manager.request(std::move(request));
+	if (!response.error.empty())
+	{
+		SPD_WARN_CLASS(COMMON::d_settings_group_utils,
+					   fmt::format("Unable to send notification. Response code {}: {}", response.http_code, response.error));
+		co_return DeliveryResult::FAILED;
+	}
+
+	// Server errors and throttling are worth retrying, anything else the server refused will be refused again.
+	if (response.http_code >= 500 || response.http_code == 408 || response.http_code == 429)
+	{
+		SPD_WARN_CLASS(COMMON::d_settings_group_utils, fmt::format("Unable to send notification. Response code {}", response.http_code));
+		co_return DeliveryResult::FAILED;
+	}
+
+	if (response.http_code >= 400)
+	{
+		SPD_ERROR_CLASS(COMMON::d_settings_group_utils, fmt::format("Notification rejected. Response code {}", response.http_code));
+		co_return DeliveryResult::REJECTED;
+	}
+
+	co_return DeliveryResult::DELIVERED;
 }
 
 } // namespace UTILS
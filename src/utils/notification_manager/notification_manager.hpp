@@ -1,10 +1,22 @@
 #ifndef NOTIFICATION_MANAGER_HPP
 #define NOTIFICATION_MANAGER_HPP
 
+#include "bounded_queue.hpp"
+#include "duplicate_filter.hpp"
+#include "latency_tracker.hpp"
 #include "manager_singleton.hpp"
+#include "rate_limiter.hpp"
+#include "task.hpp"
 
-#include <future>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 namespace UTILS
 {
@@ -30,22 +42,52 @@ struct NotificationMessage
 	std::string				 attachment_url	 = "";
 	std::string				 email_recipient = "";
 	std::vector<std::string> actions		 = {}; // Rework with custom class
+	std::string				 idempotency_key = ""; // Generated by the outbox when empty
 };
 
+enum class NotificationOverflowPolicy
+{
+	BLOCK,
+	DROP_OLDEST,
+	DROP_NEWEST
+};
+
+struct NotificationQueueStats
+{
+	size_t			 depth			  = 0;
+	size_t			 capacity		  = 0;
+	uint64_t		 enqueued		  = 0;
+	uint64_t		 delivered		  = 0;
+	uint64_t		 failed			  = 0;
+	uint64_t		 dropped		  = 0;
+	uint64_t		 deferred		  = 0; // Outbox entries pushed out of a full queue, redelivered later.
+	uint64_t		 coalesced		  = 0;
+	uint64_t		 suppressed		  = 0;
+	uint64_t		 rate_limited	  = 0;
+	LatencyHistogram delivery_latency = {};
+};
+
+class NetworkManager;
+class NotificationOutbox;
+struct NotificationOutboxStats;
+class SettingsManager;
+
 class NotificationManager : public UTILS::ManagerSingleton<NotificationManager>
 {
 	friend class ManagerSingleton<NotificationManager>;
 
 private:
-	NotificationManager() = default;
+	NotificationManager();
 
 	void initialize() override;
 
 public:
+	using Dependencies = ManagerDependencies<SettingsManager, NetworkManager>;
+
 	std::string_view get_manager_name() const override;
 
 	~NotificationManager();
-	void shutdown();
+	void shutdown() override;
 
 	void send_notification(std::string_view				   topic,
 						   std::string_view				   message,
@@ -56,9 +98,93 @@ public:
 						   std::string_view				   schedule		   = "");
 	void send_notification(const NotificationMessage& notification);
 
+	// Resumes on the network event loop thread once the notification server has answered.
+	Task<bool> send_notification_async(NotificationMessage notification);
+
+	NotificationQueueStats	get_queue_stats() const;
+	NotificationOutboxStats get_outbox_stats() const;
+
+private:
+	enum class DeliveryResult
+	{
+		DELIVERED,
+		REJECTED,
+		FAILED
+	};
+
+	struct QueuedNotification
+	{
+		NotificationMessage					  notification;
+		std::chrono::steady_clock::time_point enqueued;
+		uint64_t							  outbox_id = 0;
+	};
+
+	struct CoalescedGroup
+	{
+		NotificationMessage					  first;
+		NotificationMessage					  last;
+		NotificationPriority				  priority = NotificationPriority::MIN;
+		uint64_t							  count	   = 0;
+		std::chrono::steady_clock::time_point first_seen;
+		std::chrono::steady_clock::time_point last_seen;
+		std::chrono::steady_clock::time_point window_end;
+	};
+
+	bool							 coalesce(const NotificationMessage& notification);
+	std::vector<NotificationMessage> collect_digests(std::chrono::steady_clock::time_point now);
+	void							 coalesce_worker();
+	void							 enqueue(NotificationMessage notification);
+	void							 dispatch(QueuedNotification queued);
+	void							 drop_queued(const QueuedNotification& queued);
+	void							 dispatch_worker();
+	Task<void>						 deliver_queued(QueuedNotification queued);
+	Task<DeliveryResult>			 deliver_notification(NotificationMessage notification);
+
+	static NotificationMessage make_digest(const CoalescedGroup& group);
+
+private:
+	std::unique_ptr<BoundedQueue<QueuedNotification>> m_queue;
+	std::vector<std::thread>						  m_workers;
+	NotificationOverflowPolicy						  m_overflow_policy	= NotificationOverflowPolicy::BLOCK;
+	std::atomic<bool>								  m_running			= false;
+
+	// Bumped after every push and pop so that idle workers and blocked producers can wait on them.
+	std::atomic<uint64_t> m_queued_signal = 0;
+	std::atomic<uint64_t> m_space_signal  = 0;
+
+	// Deliveries started by the workers that have not finished yet, bounded by m_max_in_flight.
+	uint64_t			  m_max_in_flight = 1;
+	std::atomic<uint64_t> m_in_flight	  = 0;
+
+	std::atomic<uint64_t> m_enqueued	 = 0;
+	std::atomic<uint64_t> m_delivered	 = 0;
+	std::atomic<uint64_t> m_failed		 = 0;
+	std::atomic<uint64_t> m_dropped		 = 0;
+	std::atomic<uint64_t> m_deferred	 = 0;
+	std::atomic<uint64_t> m_coalesced	 = 0;
+	std::atomic<uint64_t> m_suppressed	 = 0;
+	std::atomic<uint64_t> m_rate_limited = 0;
+
+	std::chrono::milliseconds						m_coalesce_window	 = std::chrono::milliseconds::zero();
+	uint64_t										m_coalesce_threshold = 0;
+	std::unordered_map<std::string, CoalescedGroup> m_coalesce_groups;
+	std::thread										m_coalesce_thread;
+	std::condition_variable							m_coalesce_condition;
+
+	std::unique_ptr<DuplicateFilter> m_duplicate_filter;
+	std::unique_ptr<RateLimiter>	 m_topic_limiter;
+	std::unique_ptr<RateLimiter>	 m_priority_limiter;
+
+	std::unique_ptr<NotificationOutbox> m_outbox;
+
+	// Kept alive so that the subscription can still be removed during static destruction.
+	std::shared_ptr<SettingsManager> m_settings_manager;
+	uint64_t						 m_settings_subscription = 0;
+
 protected:
-	static std::mutex			   m_notification_mutex;
-	std::vector<std::future<void>> m_futures;
+	static std::mutex m_notification_mutex;
+	LatencyHistogram  m_delivery_latency;
+	std::mutex		  m_coalesce_mutex;
 };
 } // namespace UTILS
 
@@ -0,0 +1,503 @@
+#include "notification_outbox.hpp"
+
+#include "spdlog_wrapper.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <optional>
+
+namespace
+{
+constexpr uint64_t OUTBOX_ENTRY_VERSION = 1;
+
+uint64_t get_unix_time_ms()
+{
+	return static_cast<uint64_t>(
+		std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+// Big-endian so that the cursor walks entries in submission order.
+std::string encode_id(uint64_t id)
+{
+	std::string key(sizeof(id), '\0');
+
+	for (size_t i = 0; i < sizeof(id); ++i)
+	{
+		key[i] = static_cast<char>((id >> (8 * (sizeof(id) - 1 - i))) & 0xFF);
+	}
+
+	return key;
+}
+
+uint64_t decode_id(std::string_view key)
+{
+	uint64_t id = 0;
+
+	for (char byte : key.substr(0, sizeof(id)))
+	{
+		id = (id << 8) | static_cast<unsigned char>(byte);
+	}
+
+	return id;
+}
+
+void append_u64(std::string& output, uint64_t value)
+{
+	output.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void append_string(std::string& output, std::string_view value)
+{
+	append_u64(output, value.size());
+	output.append(value);
+}
+
+void append_strings(std::string& output, const std::vector<std::string>& values)
+{
+	append_u64(output, values.size());
+
+	for (const auto& value : values)
+	{
+		append_string(output, value);
+	}
+}
+
+class EntryReader
+{
+public:
+	explicit EntryReader(std::string_view data) :
+		m_data(data)
+	{}
+
+	bool read_u64(uint64_t& value)
+	{
+		if (this->m_data.size() < sizeof(value))
+		{
+			return false;
+		}
+
+		std::memcpy(&value, this->m_data.data(), sizeof(value));
+		this->m_data.remove_prefix(sizeof(value));
+		return true;
+	}
+
+	bool read_string(std::string& value)
+	{
+		uint64_t length = 0;
+
+		if (!this->read_u64(length) || this->m_data.size() < length)
+		{
+			return false;
+		}
+
+		value.assign(this->m_data.substr(0, length));
+		this->m_data.remove_prefix(length);
+		return true;
+	}
+
+	bool read_strings(std::vector<std::string>& values)
+	{
+		uint64_t count = 0;
+
+		if (!this->read_u64(count))
+		{
+			return false;
+		}
+
+		for (uint64_t i = 0; i < count; ++i)
+		{
+			std::string value;
+
+			if (!this->read_string(value))
+			{
+				return false;
+			}
+
+			values.push_back(std::move(value));
+		}
+
+		return true;
+	}
+
+private:
+	std::string_view m_data;
+};
+
+std::string encode_entry(const UTILS::OutboxEntry& entry)
+{
+	const UTILS::NotificationMessage& notification = entry.notification;
+
+	std::string output;
+	output.reserve(notification.message.size() + 256);
+
+	append_u64(output, OUTBOX_ENTRY_VERSION);
+	append_u64(output, entry.attempts);
+	append_u64(output, entry.next_attempt);
+	append_string(output, notification.idempotency_key);
+	append_string(output, notification.topic);
+	append_string(output, notification.title);
+	append_string(output, notification.message);
+	append_u64(output, static_cast<uint64_t>(notification.priority));
+	append_strings(output, notification.tags);
+	append_u64(output, notification.enable_markdown);
+	append_string(output, notification.schedule);
+	append_string(output, notification.click_action);
+	append_string(output, notification.attachment_url);
+	append_string(output, notification.email_recipient);
+	append_strings(output, notification.actions);
+
+	return output;
+}
+
+std::optional<UTILS::OutboxEntry> decode_entry(uint64_t id, std::string_view data)
+{
+	EntryReader					reader(data);
+	UTILS::OutboxEntry			entry;
+	UTILS::NotificationMessage&	notification	= entry.notification;
+	uint64_t					version			= 0;
+	uint64_t					attempts		= 0;
+	uint64_t					priority		= 0;
+	uint64_t					enable_markdown	= 0;
+
+	if (!reader.read_u64(version) || version != OUTBOX_ENTRY_VERSION || !reader.read_u64(attempts) || !reader.read_u64(entry.next_attempt) ||
+		!reader.read_string(notification.idempotency_key) || !reader.read_string(notification.topic) ||
+		!reader.read_string(notification.title) || !reader.read_string(notification.message) || !reader.read_u64(priority) ||
+		!reader.read_strings(notification.tags) || !reader.read_u64(enable_markdown) || !reader.read_string(notification.schedule) ||
+		!reader.read_string(notification.click_action) || !reader.read_string(notification.attachment_url) ||
+		!reader.read_string(notification.email_recipient) || !reader.read_strings(notification.actions))
+	{
+		return std::nullopt;
+	}
+
+	entry.id					 = id;
+	entry.attempts				 = static_cast<uint32_t>(attempts);
+	notification.priority		 = static_cast<UTILS::NotificationPriority>(priority);
+	notification.enable_markdown = enable_markdown != 0;
+
+	return entry;
+}
+} // anonymous namespace
+
+namespace UTILS
+{
+NotificationOutbox::~NotificationOutbox()
+{
+	this->close();
+}
+
+bool NotificationOutbox::open(const NotificationOutboxOptions& options, DispatchCallback dispatch)
+{
+	this->m_options	 = options;
+	this->m_dispatch = std::move(dispatch);
+	this->m_random.seed(std::random_device {}());
+
+	auto now		 = std::chrono::steady_clock::now();
+	auto unix_now_ms = get_unix_time_ms();
+
+	try
+	{
+		std::filesystem::create_directories(options.path);
+
+		this->m_env = lmdb::env::create();
+		this->m_env.set_mapsize(std::max<size_t>(options.max_size_bytes, 1UL * 1024UL * 1024UL));
+		this->m_env.set_max_dbs(2);
+		this->m_env.open(options.path.string().c_str(), MDB_NOTLS, 0664);
+
+		auto wtxn			= lmdb::txn::begin(this->m_env);
+		this->m_entries_dbi = lmdb::dbi::open(wtxn, "entries", MDB_CREATE);
+		this->m_keys_dbi	= lmdb::dbi::open(wtxn, "keys", MDB_CREATE);
+
+		{
+			auto			 cursor = lmdb::cursor::open(wtxn, this->m_entries_dbi);
+			std::string_view key;
+			std::string_view value;
+
+			if (cursor.get(key, value, MDB_FIRST))
+			{
+				do
+				{
+					uint64_t id		= decode_id(key);
+					auto	 entry	= decode_entry(id, value);
+					this->m_next_id = std::max(this->m_next_id, id + 1);
+
+					if (!entry)
+					{
+						SPD_WARN_CLASS(COMMON::d_settings_group_utils, fmt::format("Skipping unreadable notification outbox entry {}", id));
+						continue;
+					}
+
+					auto delay = std::chrono::milliseconds(entry->next_attempt > unix_now_ms ? entry->next_attempt - unix_now_ms : 0);
+					this->m_retries.emplace(now + delay, std::move(*entry));
+				} while (cursor.get(key, value, MDB_NEXT));
+			}
+		}
+
+		wtxn.commit();
+	}
+	catch (const std::exception& e)
+	{
+		SPD_ERROR_CLASS(COMMON::d_settings_group_utils,
+						fmt::format("Failed to open notification outbox at {}: {}", options.path.string(), e.what()));
+		this->m_env = lmdb::env {nullptr};
+		this->m_retries.clear();
+		return false;
+	}
+
+	this->m_stored = this->m_retries.size();
+
+	SPD_INFO_CLASS(COMMON::d_settings_group_utils,
+				   fmt::format("Notification outbox opened at {} ({} pending notifications)", options.path.string(), this->m_retries.size()));
+
+	this->m_running = true;
+	this->m_thread	= std::thread(&NotificationOutbox::run, this);
+	return true;
+}
+
+// May be called again after the dispatchers have drained their queue to record their last results.
+void NotificationOutbox::close()
+{
+	if (this->m_running.exchange(false))
+	{
+		{
+			std::lock_guard<std::mutex> lock(this->m_outbox_mutex);
+		}
+		this->m_outbox_condition.notify_all();
+
+		if (this->m_thread.joinable())
+		{
+			this->m_thread.join();
+		}
+	}
+
+	if (!this->m_env)
+	{
+		return;
+	}
+
+	std::vector<OutboxEntry>			   staged;
+	std::vector<std::pair<uint64_t, bool>> results;
+	{
+		std::lock_guard<std::mutex> lock(this->m_outbox_mutex);
+		staged.swap(this->m_staged);
+		results.swap(this->m_results);
+	}
+
+	this->commit(staged, results);
+}
+
+void NotificationOutbox::stage(NotificationMessage notification)
+{
+	{
+		std::lock_guard<std::mutex> lock(this->m_outbox_mutex);
+		this->m_staged.push_back(OutboxEntry {.notification = std::move(notification)});
+	}
+
+	this->m_outbox_condition.notify_one();
+}
+
+void NotificationOutbox::complete(uint64_t id)
+{
+	{
+		std::lock_guard<std::mutex> lock(this->m_outbox_mutex);
+		this->m_results.emplace_back(id, true);
+	}
+
+	this->m_outbox_condition.notify_one();
+}
+
+void NotificationOutbox::retry(uint64_t id)
+{
+	{
+		std::lock_guard<std::mutex> lock(this->m_outbox_mutex);
+		this->m_results.emplace_back(id, false);
+	}
+
+	this->m_outbox_condition.notify_one();
+}
+
+NotificationOutboxStats NotificationOutbox::get_stats() const
+{
+	NotificationOutboxStats stats;
+	stats.stored	 = this->m_stored;
+	stats.commits	 = this->m_commits;
+	stats.retried	 = this->m_retried;
+	stats.abandoned	 = this->m_abandoned;
+	stats.duplicates = this->m_duplicates;
+	return stats;
+}
+
+void NotificationOutbox::run()
+{
+	std::vector<OutboxEntry>			   staged;
+	std::vector<std::pair<uint64_t, bool>> results;
+
+	while (this->m_running)
+	{
+		{
+			std::unique_lock<std::mutex> lock(this->m_outbox_mutex);
+
+			if (this->m_staged.empty() && this->m_results.empty() && this->m_running)
+			{
+				if (this->m_retries.empty())
+				{
+					this->m_outbox_condition.wait(lock);
+				}
+				else
+				{
+					this->m_outbox_condition.wait_until(lock, this->m_retries.begin()->first);
+				}
+			}
+
+			staged.swap(this->m_staged);
+			results.swap(this->m_results);
+		}
+
+		// Everything that piled up while the previous batch was being written goes into one transaction.
+		this->commit(staged, results);
+
+		auto now = std::chrono::steady_clock::now();
+
+		while (!this->m_retries.empty() && this->m_retries.begin()->first <= now && this->m_running)
+		{
+			auto node = this->m_retries.extract(this->m_retries.begin());
+			this->m_inflight.emplace(node.mapped().id, node.mapped());
+			this->m_dispatch(node.mapped().id, std::move(node.mapped().notification));
+		}
+
+		for (auto& entry : staged)
+		{
+			this->m_inflight.emplace(entry.id, entry);
+			this->m_dispatch(entry.id, std::move(entry.notification));
+		}
+
+		staged.clear();
+		results.clear();
+	}
+}
+
+void NotificationOutbox::commit(std::vector<OutboxEntry>& appended, std::vector<std::pair<uint64_t, bool>>& results)
+{
+	if (appended.empty() && results.empty())
+	{
+		return;
+	}
+
+	std::vector<const OutboxEntry*> updated;
+	std::vector<OutboxEntry>		removed;
+
+	for (const auto& [id, delivered] : results)
+	{
+		auto iterator = this->m_inflight.find(id);
+		if (iterator == this->m_inflight.end())
+		{
+			continue;
+		}
+
+		OutboxEntry entry = std::move(iterator->second);
+		this->m_inflight.erase(iterator);
+
+		if (delivered)
+		{
+			removed.push_back(std::move(entry));
+			continue;
+		}
+
+		if (++entry.attempts >= this->m_options.max_attempts)
+		{
+			SPD_ERROR_CLASS(COMMON::d_settings_group_utils,
+							fmt::format("Giving up on notification '{}' after {} attempts.", entry.notification.title, entry.attempts));
+			++this->m_abandoned;
+			removed.push_back(std::move(entry));
+			continue;
+		}
+
+		auto delay		   = this->get_retry_delay(entry.attempts);
+		entry.next_attempt = get_unix_time_ms() + static_cast<uint64_t>(delay.count());
+		++this->m_retried;
+
+		SPD_WARN_CLASS(COMMON::d_settings_group_utils,
+					   fmt::format("Notification '{}' failed, retrying in {} ms (attempt {}).",
+								   entry.notification.title,
+								   delay.count(),
+								   entry.attempts + 1));
+
+		auto retry = this->m_retries.emplace(std::chrono::steady_clock::now() + delay, std::move(entry));
+		updated.push_back(&retry->second);
+	}
+
+	if (!this->m_env)
+	{
+		return;
+	}
+
+	try
+	{
+		auto wtxn = lmdb::txn::begin(this->m_env);
+
+		for (auto iterator = appended.begin(); iterator != appended.end();)
+		{
+			std::string& key = iterator->notification.idempotency_key;
+			std::string_view existing;
+
+			if (key.empty())
+			{
+				key = fmt::format("{:016x}{:016x}", this->m_random(), this->m_random());
+			}
+			else if (this->m_keys_dbi.get(wtxn, key, existing))
+			{
+				SPD_DEBUG_CLASS(COMMON::d_settings_group_utils, fmt::format("Skipping duplicate notification with key {}", key));
+				++this->m_duplicates;
+				iterator = appended.erase(iterator);
+				continue;
+			}
+
+			iterator->id	= this->m_next_id++;
+			std::string id	= encode_id(iterator->id);
+
+			this->m_entries_dbi.put(wtxn, id, encode_entry(*iterator));
+			this->m_keys_dbi.put(wtxn, key, id);
+			++iterator;
+		}
+
+		for (const auto* entry : updated)
+		{
+			this->m_entries_dbi.put(wtxn, encode_id(entry->id), encode_entry(*entry));
+		}
+
+		for (const auto& entry : removed)
+		{
+			this->m_entries_dbi.del(wtxn, encode_id(entry.id));
+			this->m_keys_dbi.del(wtxn, entry.notification.idempotency_key);
+		}
+
+		wtxn.commit();
+
+		this->m_stored += appended.size();
+		this->m_stored -= std::min<uint64_t>(this->m_stored, removed.size());
+		++this->m_commits;
+	}
+	catch (const lmdb::error& e)
+	{
+		// Delivery still goes ahead, the notifications are just not crash-safe.
+		SPD_ERROR_CLASS(COMMON::d_settings_group_utils, fmt::format("Failed to write notification outbox: {}", e.what()));
+
+		for (auto& entry : appended)
+		{
+			if (entry.id == 0)
+			{
+				entry.id = this->m_next_id++;
+			}
+		}
+	}
+}
+
+std::chrono::milliseconds NotificationOutbox::get_retry_delay(uint32_t attempts)
+{
+	auto backoff = this->m_options.initial_backoff * (uint64_t(1) << std::min<uint32_t>(attempts - 1, 20));
+	auto capped	 = std::min<std::chrono::milliseconds>(std::chrono::duration_cast<std::chrono::milliseconds>(backoff), this->m_options.max_backoff);
+
+	// Jitter between half and the full delay so that notifications that failed together do not retry together.
+	std::uniform_int_distribution<int64_t> jitter(capped.count() / 2, capped.count());
+	return std::chrono::milliseconds(jitter(this->m_random));
+}
+} // namespace UTILS
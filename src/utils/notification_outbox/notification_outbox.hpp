@@ -0,0 +1,110 @@
+#ifndef NOTIFICATION_OUTBOX_HPP
+#define NOTIFICATION_OUTBOX_HPP
+
+#include "notification_manager.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <lmdb++.h>
+#include <map>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace UTILS
+{
+struct NotificationOutboxOptions
+{
+	fs::path				  path			  = "./data/notification-outbox/";
+	size_t					  max_size_bytes  = 64UL * 1024UL * 1024UL;
+	uint32_t				  max_attempts	  = 10;
+	std::chrono::milliseconds initial_backoff = std::chrono::milliseconds(1000);
+	std::chrono::milliseconds max_backoff	  = std::chrono::minutes(10);
+};
+
+struct NotificationOutboxStats
+{
+	uint64_t stored		= 0;
+	uint64_t commits	= 0;
+	uint64_t retried	= 0;
+	uint64_t abandoned	= 0;
+	uint64_t duplicates = 0;
+};
+
+struct OutboxEntry
+{
+	uint64_t			id			 = 0;
+	uint32_t			attempts	 = 0;
+	uint64_t			next_attempt = 0; // Unix time in milliseconds
+	NotificationMessage notification;
+};
+
+// Write-ahead log for outgoing notifications. Staged messages are committed in batches by a background
+// thread before being handed to the dispatcher, and stay stored until delivery succeeds or retries run out.
+class NotificationOutbox
+{
+public:
+	using DispatchCallback = std::function<void(uint64_t, NotificationMessage)>;
+
+	NotificationOutbox() = default;
+	~NotificationOutbox();
+
+	NotificationOutbox(const NotificationOutbox&)			 = delete;
+	NotificationOutbox& operator=(const NotificationOutbox&) = delete;
+
+	// Pending entries from a previous run are dispatched again once the outbox is open.
+	bool open(const NotificationOutboxOptions& options, DispatchCallback dispatch);
+	void close();
+
+	void stage(NotificationMessage notification);
+	void complete(uint64_t id);
+	void retry(uint64_t id);
+
+	NotificationOutboxStats get_stats() const;
+
+private:
+	void run();
+	void commit(std::vector<OutboxEntry>& appended, std::vector<std::pair<uint64_t, bool>>& results);
+
+	std::chrono::milliseconds get_retry_delay(uint32_t attempts);
+
+private:
+	NotificationOutboxOptions m_options;
+	DispatchCallback		  m_dispatch;
+
+	lmdb::env m_env {nullptr};
+	lmdb::dbi m_entries_dbi;
+	lmdb::dbi m_keys_dbi;
+
+	std::thread		  m_thread;
+	std::atomic<bool> m_running = false;
+	uint64_t		  m_next_id = 1;
+	std::mt19937_64	  m_random;
+
+	// Owned by the outbox thread once it has started.
+	std::unordered_map<uint64_t, OutboxEntry>						  m_inflight;
+	std::multimap<std::chrono::steady_clock::time_point, OutboxEntry> m_retries;
+
+	std::atomic<uint64_t> m_stored	   = 0;
+	std::atomic<uint64_t> m_commits	   = 0;
+	std::atomic<uint64_t> m_retried	   = 0;
+	std::atomic<uint64_t> m_abandoned  = 0;
+	std::atomic<uint64_t> m_duplicates = 0;
+
+protected:
+	std::mutex							   m_outbox_mutex;
+	std::condition_variable				   m_outbox_condition;
+	std::vector<OutboxEntry>			   m_staged;
+	std::vector<std::pair<uint64_t, bool>> m_results;
+};
+} // namespace UTILS
+
+#endif // NOTIFICATION_OUTBOX_HPP
@@ -3,6 +3,8 @@
 #include "settings_manager.hpp"
 #include "spdlog_wrapper.hpp"
 
+#include <ranges>
+
 namespace UTILS
 {
 
@@ -20,7 +22,15 @@ void OptionManager::initialize()
 void OptionManager::set_description(const std::string& app_name, const std::string& app_description)
 {
 	std::lock_guard<std::mutex> lock(this->m_options_mutex);
+
+	if (this->m_parsed_options.load(std::memory_order_acquire))
+	{
+		SPD_ERROR_CLASS(COMMON::d_settings_group_options, "Unable to set the description, options have already been parsed.");
+		return;
+	}
+
 	this->m_options = std::make_unique<cxxopts::Options>(app_name, app_description);
+	this->m_option_specs.clear();
 
 	return;
 }
@@ -28,7 +38,7 @@ void OptionManager::set_description(const std::string& app_name, const std::stri
 OptionManager::~OptionManager()
 {
 	this->m_options.reset();
-	this->m_parsed_options.reset();
+	this->m_parsed_options.store(nullptr);
 
 	return;
 }
@@ -41,15 +51,23 @@ void OptionManager::parse_options(const int argc, const char** argv)
 		SPD_ERROR_CLASS(COMMON::d_settings_group_options, "Unable to parse options, option manager is not initialized.");
 	}
 
+	if (this->m_parsed_options.load(std::memory_order_acquire))
+	{
+		SPD_ERROR_CLASS(COMMON::d_settings_group_options, "Options have already been parsed.");
+		return;
+	}
+
 	try
 	{
-		this->m_parsed_options = std::make_unique<cxxopts::ParseResult>(this->m_options->parse(argc, argv));
+		auto result = this->m_options->parse(argc, argv);
 
-		for (const auto& unmatched_argument : this->m_parsed_options->unmatched())
+		for (const auto& unmatched_argument : result.unmatched())
 		{
 			SPD_WARN_CLASS(COMMON::d_settings_group_options, fmt::format("Unsupported argument passed: {}", unmatched_argument));
 		}
 
+		this->m_parsed_options.store(this->freeze_options(result), std::memory_order_release);
+
 		return;
 	}
 	catch (const cxxopts::exceptions::exception& e)
@@ -64,26 +82,117 @@ void OptionManager::parse_options(const int argc, const char** argv)
 	exit(1);
 }
 
+std::shared_ptr<const OptionManager::ParsedOptions> OptionManager::freeze_options(const cxxopts::ParseResult& result) const
+{
+	auto parsed_options = std::make_shared<ParsedOptions>();
+
+	for (const auto& spec : this->m_option_specs)
+	{
+		ParsedOption option;
+		option.count = result.count(spec.names.back());
+
+		try
+		{
+			option.value = spec.convert(result, spec.names.back());
+		}
+		catch (const cxxopts::exceptions::exception&)
+		{
+			// Neither passed nor defaulted, the value stays empty.
+		}
+
+		for (const auto& name : spec.names)
+		{
+			parsed_options->index.emplace(name, parsed_options->options.size());
+		}
+
+		parsed_options->options.push_back(std::move(option));
+	}
+
+	for (const auto& argument : result.arguments())
+	{
+		parsed_options->arguments.emplace_back(argument.key(), argument.value());
+
+		if (auto position = parsed_options->index.find(argument.key()); position != parsed_options->index.end())
+		{
+			parsed_options->options[position->second].values.push_back(argument.value());
+		}
+	}
+
+	return parsed_options;
+}
+
+std::shared_ptr<const OptionManager::ParsedOptions> OptionManager::get_parsed_options() const
+{
+	auto parsed_options = this->m_parsed_options.load(std::memory_order_acquire);
+
+	if (!parsed_options)
+	{
+		SPD_ERROR_CLASS(COMMON::d_settings_group_options, "Options have not been parsed yet. Call parse_options() first.");
+	}
+
+	return parsed_options;
+}
+
+const OptionManager::ParsedOption* OptionManager::ParsedOptions::find(const std::string& name) const
+{
+	auto position = this->index.find(name);
+	return position != this->index.end() ? &this->options[position->second] : nullptr;
+}
+
+// Callers hold m_options_mutex.
+bool OptionManager::register_option(const std::string& name, OptionConverter convert)
+{
+	if (!this->m_options)
+	{
+		SPD_ERROR_CLASS(COMMON::d_settings_group_options, "Unable to add option, option manager is not initialized.");
+		return false;
+	}
+
+	if (this->m_parsed_options.load(std::memory_order_acquire))
+	{
+		SPD_ERROR_CLASS(COMMON::d_settings_group_options, fmt::format("Unable to add option {}, options have already been parsed.", name));
+		return false;
+	}
+
+	OptionSpec spec;
+	spec.convert = std::move(convert);
+
+	for (const auto& part : name | std::views::split(','))
+	{
+		std::string option_name(part.begin(), part.end());
+		std::erase(option_name, ' ');
+
+		if (!option_name.empty())
+		{
+			spec.names.push_back(std::move(option_name));
+		}
+	}
+
+	this->m_option_specs.push_back(std::move(spec));
+
+	return true;
+}
+
 bool OptionManager::has_option(const std::string& name) const
 {
-	std::lock_guard<std::mutex> lock(this->m_options_mutex);
+	auto parsed_options = this->get_parsed_options();
 
-	if (!this->m_parsed_options)
+	if (!parsed_options)
 	{
-		SPD_ERROR_CLASS(COMMON::d_settings_group_options, "Options have not been parsed yet. Call parseOptions() first.");
 		return false;
 	}
 
-	return this->m_parsed_options->count(name) > 0;
+	const ParsedOption* option = parsed_options->find(name);
+
+	return option && option->count > 0;
 }
 
 void OptionManager::add_option(const std::string& name, const std::string& description)
 {
 	std::lock_guard<std::mutex> lock(this->m_options_mutex);
 
-	if (!this->m_options)
+	if (!this->register_option(name, convert_option<bool>))
 	{
-		SPD_ERROR_CLASS(COMMON::d_settings_group_options, "Unable to add option, option manager is not initialized.");
 		return;
 	}
 
@@ -94,15 +203,30 @@ void OptionManager::add_option(const std::string& name, const std::string& descr
 
 size_t OptionManager::get_option_count(const std::string& name) const
 {
-	std::lock_guard<std::mutex> lock(this->m_options_mutex);
+	auto parsed_options = this->get_parsed_options();
 
-	if (!this->m_parsed_options)
+	if (!parsed_options)
 	{
-		SPD_ERROR_CLASS(COMMON::d_settings_group_options, "Options have not been parsed yet. Call parseOptions() first.");
 		return 0;
 	}
 
-	return this->m_parsed_options->count(name);
+	const ParsedOption* option = parsed_options->find(name);
+
+	return option ? option->count : 0;
+}
+
+std::vector<std::string> OptionManager::get_option_values(const std::string& name) const
+{
+	auto parsed_options = this->get_parsed_options();
+
+	if (!parsed_options)
+	{
+		return {};
+	}
+
+	const ParsedOption* option = parsed_options->find(name);
+
+	return option ? option->values : std::vector<std::string> {};
 }
 
 void OptionManager::log_help() const
@@ -127,11 +251,16 @@ void OptionManager::log_help() const
 
 void OptionManager::debug_log() const
 {
-	std::lock_guard<std::mutex> lock(this->m_options_mutex);
+	auto parsed_options = this->get_parsed_options();
+
+	if (!parsed_options)
+	{
+		return;
+	}
 
 	auto settings_manager = UTILS::SettingsManager::instance();
 
-	auto arguments = this->m_parsed_options->arguments();
+	const auto& arguments = parsed_options->arguments;
 
 	SPD_INFO_CLASS(COMMON::d_settings_group_options, "===========================================================");
 	SPD_INFO_CLASS(COMMON::d_settings_group_options, "\tProject Information");
@@ -146,20 +275,21 @@ void OptionManager::debug_log() const
 
 	for (int i = 0; i < arguments.size(); ++i)
 	{
-		auto key_temp = arguments.at(i).key();
-		auto val_temp = arguments.at(i).value();
+		const auto& [key_temp, val_temp] = arguments.at(i);
 
 		SPD_INFO_CLASS(COMMON::d_settings_group_options, fmt::format("\tArgument [{}]: {} = {}", i, key_temp, val_temp));
 	}
 
-	auto dumped_settings = settings_manager->dump() | std::ranges::views::split('\n') | std::ranges::to<std::vector<std::string>>();
+	auto setting_origins = settings_manager->get_setting_origins();
 
 	SPD_INFO_CLASS(COMMON::d_settings_group_options, "===========================================================");
 	SPD_INFO_CLASS(COMMON::d_settings_group_options, "\tSettings");
 	SPD_INFO_CLASS(COMMON::d_settings_group_options, "-----------------------------------------------------------");
-	for (auto& line : dumped_settings)
+	for (const auto& origin : setting_origins)
 	{
-		SPD_INFO_CLASS(COMMON::d_settings_group_options, fmt::format("\t{}", line));
+		SPD_INFO_CLASS(
+			COMMON::d_settings_group_options,
+			fmt::format("\t{} = {} ({}: {})", origin.path, origin.value, UTILS::get_setting_source_name(origin.source), origin.location));
 	}
 	SPD_INFO_CLASS(COMMON::d_settings_group_options, "===========================================================");
 }
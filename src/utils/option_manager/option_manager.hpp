@@ -3,10 +3,16 @@
 
 #include "manager_singleton.hpp"
 
+#include <any>
+#include <atomic>
 #include <cxxopts.hpp>
+#include <functional>
 #include <memory>
 #include <string>
 #include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace UTILS
 {
@@ -24,12 +30,16 @@ public:
 
 	~OptionManager();
 
+	// Options are frozen once parsed, later calls to set_description and add_option are rejected.
 	void   set_description(const std::string& app_name, const std::string& app_description);
 	void   parse_options(const int argc, const char** argv);
 	bool   has_option(const std::string& name) const;
 	void   add_option(const std::string& name, const std::string& description);
 	size_t get_option_count(const std::string& name) const;
 
+	// Raw value of every occurrence of an option, in command line order.
+	std::vector<std::string> get_option_values(const std::string& name) const;
+
 	void log_help() const;
 	void debug_log() const;
 
@@ -44,8 +54,45 @@ public:
 	T get_option(const std::string& name) const;
 
 private:
-	std::unique_ptr<cxxopts::Options>	  m_options;
-	std::unique_ptr<cxxopts::ParseResult> m_parsed_options;
+	// Reads the typed value of an option from the parse result, looked up by one of its names.
+	using OptionConverter = std::function<std::any(const cxxopts::ParseResult&, const std::string&)>;
+
+	struct OptionSpec
+	{
+		std::vector<std::string> names;
+		OptionConverter			 convert;
+	};
+
+	struct ParsedOption
+	{
+		size_t					 count = 0;
+		std::any				 value;	 // Empty when the option was neither passed nor has a default
+		std::vector<std::string> values; // Raw value of every occurrence
+	};
+
+	// Built once by parse_options and never modified afterwards, so it is read without a lock.
+	// Every name of an option maps to the same entry.
+	struct ParsedOptions
+	{
+		std::vector<ParsedOption>						 options;
+		std::unordered_map<std::string, size_t>			 index;
+		std::vector<std::pair<std::string, std::string>> arguments;
+
+		const ParsedOption* find(const std::string& name) const;
+	};
+
+	bool register_option(const std::string& name, OptionConverter convert);
+
+	template<typename T>
+	static std::any convert_option(const cxxopts::ParseResult& result, const std::string& key);
+
+	std::shared_ptr<const ParsedOptions> freeze_options(const cxxopts::ParseResult& result) const;
+	std::shared_ptr<const ParsedOptions> get_parsed_options() const;
+
+private:
+	std::unique_ptr<cxxopts::Options>				   m_options;
+	std::vector<OptionSpec>							   m_option_specs;
+	std::atomic<std::shared_ptr<const ParsedOptions>> m_parsed_options;
 
 protected:
 	mutable std::mutex m_options_mutex;
@@ -58,9 +105,8 @@ void OptionManager::add_option(const std::string& name, const std::string& descr
 
 	std::lock_guard<std::mutex> lock(this->m_options_mutex);
 
-	if (!this->m_options)
+	if (!this->register_option(name, convert_option<T>))
 	{
-		SPD_ERROR_CLASS(COMMON::d_settings_group_options, "Unable to add option, option manager is not initialized");
 		return;
 	}
 
@@ -74,9 +120,8 @@ void OptionManager::add_option(const std::string& name, const std::string& descr
 {
 	std::lock_guard<std::mutex> lock(this->m_options_mutex);
 
-	if (!this->m_options)
+	if (!this->register_option(name, convert_option<T>))
 	{
-		SPD_ERROR_CLASS(COMMON::d_settings_group_options, "Unable to add option, option manager is not initialized");
 		return;
 	}
 
@@ -85,39 +130,37 @@ void OptionManager::add_option(const std::string& name, const std::string& descr
 	return;
 }
 
+template<typename T>
+std::any OptionManager::convert_option(const cxxopts::ParseResult& result, const std::string& key)
+{
+	return result[key].template as<T>();
+}
+
 template<typename T>
 T OptionManager::get_option(const std::string& name) const
 {
-	std::lock_guard<std::mutex> lock(this->m_options_mutex);
+	auto parsed_options = this->get_parsed_options();
 
-	if (!this->m_parsed_options)
+	if (!parsed_options)
 	{
 		SPD_ERROR_CLASS(COMMON::d_settings_group_options, "Options have not been parsed yet. Call parse_options() first.");
 		return T {};
 	}
 
-	if (!this->has_option(name))
+	const ParsedOption* option = parsed_options->find(name);
+
+	if (!option || !option->value.has_value())
 	{
 		SPD_WARN_CLASS(COMMON::d_settings_group_options, fmt::format("Option {} not found. Returning default value.", name));
 		return T {};
 	}
 
-	try
+	if (const T* value = std::any_cast<T>(&option->value))
 	{
-		return this->m_parsed_options->operator[](name).as<T>();
-	}
-	catch (const cxxopts::exceptions::exception& e)
-	{
-		SPD_ERROR_CLASS(COMMON::d_settings_group_options, fmt::format("Error getting option {}: {}", name, e.what()));
-	}
-	catch (const std::exception& e)
-	{
-		SPD_ERROR_CLASS(COMMON::d_settings_group_options, fmt::format("Standard exception while getting option '{}': {}", name, e.what()));
-	}
-	catch (...)
-	{
-		SPD_ERROR_CLASS(COMMON::d_settings_group_options, fmt::format("Unknown error occurred while getting option '{}'", name));
+		return *value;
 	}
+
+	SPD_ERROR_CLASS(COMMON::d_settings_group_options, fmt::format("Option {} was requested with a different type than it was added with.", name));
 	return T {};
 }
 } // namespace UTILS
@@ -0,0 +1,67 @@
+#include "rate_limiter.hpp"
+
+#include <algorithm>
+
+namespace UTILS
+{
+RateLimiter::RateLimiter(LimitResolver resolver, size_t shard_count) :
+	m_resolver(std::move(resolver)),
+	m_shard_count(std::max<size_t>(shard_count, 1)),
+	m_shards(std::make_unique<Shard[]>(m_shard_count))
+{}
+
+RateLimiter::Shard& RateLimiter::get_shard(std::string_view key)
+{
+	return this->m_shards[std::hash<std::string_view> {}(key) % this->m_shard_count];
+}
+
+bool RateLimiter::try_acquire(std::string_view key, std::chrono::steady_clock::time_point now)
+{
+	Shard& shard = this->get_shard(key);
+
+	std::unique_lock<std::mutex> lock(shard.mutex);
+
+	auto iterator = shard.buckets.find(std::string(key));
+	if (iterator == shard.buckets.end())
+	{
+		// The resolver may take locks of its own, so it runs outside the shard lock.
+		lock.unlock();
+		RateLimit limit = this->m_resolver(key);
+		limit.burst		= std::max(limit.burst, 1.0);
+		lock.lock();
+
+		iterator = shard.buckets.try_emplace(std::string(key), Bucket {limit, limit.burst, now}).first;
+	}
+
+	Bucket& bucket = iterator->second;
+
+	if (bucket.limit.rate_per_second <= 0.0)
+	{
+		return true;
+	}
+
+	if (now > bucket.last_refill)
+	{
+		auto elapsed	   = std::chrono::duration<double>(now - bucket.last_refill);
+		bucket.tokens	   = std::min(bucket.limit.burst, bucket.tokens + elapsed.count() * bucket.limit.rate_per_second);
+		bucket.last_refill = now;
+	}
+
+	if (bucket.tokens < 1.0)
+	{
+		return false;
+	}
+
+	bucket.tokens -= 1.0;
+	return true;
+}
+
+void RateLimiter::reset()
+{
+	for (size_t i = 0; i < this->m_shard_count; ++i)
+	{
+		std::lock_guard<std::mutex> lock(this->m_shards[i].mutex);
+		this->m_shards[i].buckets.clear();
+	}
+}
+} // namespace UTILS
@@ -0,0 +1,63 @@
+#ifndef RATE_LIMITER_HPP
+#define RATE_LIMITER_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace UTILS
+{
+struct RateLimit
+{
+	double rate_per_second = 0.0; // Zero or less means unlimited
+	double burst		   = 1.0;
+};
+
+// Token buckets keyed by name. Keys are spread over independently locked shards so that callers
+// limiting different keys rarely contend. The limit for a key is resolved once, when the key is first seen.
+class RateLimiter
+{
+public:
+	using LimitResolver = std::function<RateLimit(std::string_view)>;
+
+	explicit RateLimiter(LimitResolver resolver, size_t shard_count = 16);
+
+	RateLimiter(const RateLimiter&)			   = delete;
+	RateLimiter& operator=(const RateLimiter&) = delete;
+
+	bool try_acquire(std::string_view key, std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
+
+	// Keys pick up their new limit the next time they are seen.
+	void reset();
+
+private:
+	struct Bucket
+	{
+		RateLimit							  limit;
+		double								  tokens = 0.0;
+		std::chrono::steady_clock::time_point last_refill;
+	};
+
+	static constexpr size_t CACHE_LINE_SIZE = 64;
+
+	struct alignas(CACHE_LINE_SIZE) Shard
+	{
+		std::mutex								mutex;
+		std::unordered_map<std::string, Bucket> buckets;
+	};
+
+	Shard& get_shard(std::string_view key);
+
+private:
+	LimitResolver			 m_resolver;
+	size_t					 m_shard_count;
+	std::unique_ptr<Shard[]> m_shards;
+};
+} // namespace UTILS
+
+#endif // RATE_LIMITER_HPP
@@ -0,0 +1,697 @@
+#include "response_cache.hpp"
+
+#include "spdlog_wrapper.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <optional>
+#include <ranges>
+
+namespace
+{
+constexpr uint64_t CACHE_ENTRY_VERSION = 1;
+constexpr double   EVICTION_TARGET	   = 0.9;
+
+uint64_t get_unix_time()
+{
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+std::string to_lower(std::string_view value)
+{
+	std::string result(value);
+	std::ranges::transform(result, result.begin(), [](unsigned char c) {
+		return static_cast<char>(std::tolower(c));
+	});
+	return result;
+}
+
+std::string_view trim(std::string_view value)
+{
+	auto begin = value.find_first_not_of(" \t");
+	auto end   = value.find_last_not_of(" \t");
+	return begin == std::string_view::npos ? std::string_view {} : value.substr(begin, end - begin + 1);
+}
+
+void append_u64(std::string& output, uint64_t value)
+{
+	output.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void append_string(std::string& output, std::string_view value)
+{
+	append_u64(output, value.size());
+	output.append(value);
+}
+
+class EntryReader
+{
+public:
+	explicit EntryReader(std::string_view data) :
+		m_data(data)
+	{}
+
+	bool read_u64(uint64_t& value)
+	{
+		if (this->m_data.size() < sizeof(value))
+		{
+			return false;
+		}
+
+		std::memcpy(&value, this->m_data.data(), sizeof(value));
+		this->m_data.remove_prefix(sizeof(value));
+		return true;
+	}
+
+	bool read_string(std::string& value)
+	{
+		uint64_t length = 0;
+
+		if (!this->read_u64(length) || this->m_data.size() < length)
+		{
+			return false;
+		}
+
+		value.assign(this->m_data.substr(0, length));
+		this->m_data.remove_prefix(length);
+		return true;
+	}
+
+private:
+	std::string_view m_data;
+};
+
+struct CacheEntry
+{
+	uint64_t			   expires_at	   = 0;
+	uint64_t			   must_revalidate = 0;
+	std::string			   etag;
+	std::string			   last_modified;
+	UTILS::NetworkResponse response;
+};
+
+std::string encode_entry(const CacheEntry& entry)
+{
+	std::string output;
+	output.reserve(entry.response.body.size() + 256);
+
+	append_u64(output, CACHE_ENTRY_VERSION);
+	append_u64(output, static_cast<uint64_t>(entry.response.http_code));
+	append_u64(output, entry.expires_at);
+	append_u64(output, entry.must_revalidate);
+	append_string(output, entry.etag);
+	append_string(output, entry.last_modified);
+	append_u64(output, entry.response.headers.size());
+
+	for (const auto& [name, value] : entry.response.headers)
+	{
+		append_string(output, name);
+		append_string(output, value);
+	}
+
+	append_string(output, entry.response.body);
+
+	return output;
+}
+
+std::optional<CacheEntry> decode_entry(std::string_view data)
+{
+	EntryReader reader(data);
+	CacheEntry	entry;
+	uint64_t	version		 = 0;
+	uint64_t	http_code	 = 0;
+	uint64_t	header_count = 0;
+
+	if (!reader.read_u64(version) || version != CACHE_ENTRY_VERSION || !reader.read_u64(http_code) || !reader.read_u64(entry.expires_at) ||
+		!reader.read_u64(entry.must_revalidate) || !reader.read_string(entry.etag) || !reader.read_string(entry.last_modified) ||
+		!reader.read_u64(header_count))
+	{
+		return std::nullopt;
+	}
+
+	entry.response.http_code = static_cast<long>(http_code);
+
+	for (uint64_t i = 0; i < header_count; ++i)
+	{
+		std::string name;
+		std::string value;
+
+		if (!reader.read_string(name) || !reader.read_string(value))
+		{
+			return std::nullopt;
+		}
+
+		entry.response.headers.emplace_back(std::move(name), std::move(value));
+	}
+
+	if (!reader.read_string(entry.response.body))
+	{
+		return std::nullopt;
+	}
+
+	return entry;
+}
+
+std::string encode_vary(const std::vector<std::string>& vary_headers)
+{
+	std::string output;
+	append_u64(output, vary_headers.size());
+
+	for (const auto& header : vary_headers)
+	{
+		append_string(output, header);
+	}
+
+	return output;
+}
+
+std::vector<std::string> decode_vary(std::string_view data)
+{
+	EntryReader				 reader(data);
+	std::vector<std::string> vary_headers;
+	uint64_t				 count = 0;
+
+	if (!reader.read_u64(count))
+	{
+		return vary_headers;
+	}
+
+	for (uint64_t i = 0; i < count; ++i)
+	{
+		std::string header;
+
+		if (!reader.read_string(header))
+		{
+			break;
+		}
+
+		vary_headers.push_back(std::move(header));
+	}
+
+	return vary_headers;
+}
+
+std::optional<std::string_view> find_request_header(const UTILS::NetworkRequest& request, std::string_view name)
+{
+	for (const auto& [header_name, header_value] : request.headers)
+	{
+		if (to_lower(header_name) == name)
+		{
+			return header_value;
+		}
+	}
+
+	return std::nullopt;
+}
+} // anonymous namespace
+
+namespace UTILS
+{
+double ResponseCacheStats::hit_ratio() const
+{
+	uint64_t total = this->hits + this->revalidated + this->misses;
+	return total ? static_cast<double>(this->hits + this->revalidated) / static_cast<double>(total) : 0.0;
+}
+
+ResponseCache::~ResponseCache()
+{
+	this->stop_writer();
+
+	std::lock_guard<std::mutex> lock(this->m_cache_mutex);
+
+	if (!this->m_env || this->m_pending_access.empty())
+	{
+		return;
+	}
+
+	try
+	{
+		auto wtxn = lmdb::txn::begin(this->m_env);
+		this->flush_access_times(wtxn);
+		wtxn.commit();
+	}
+	catch (const lmdb::error& e)
+	{
+		SPD_ERROR_CLASS(COMMON::d_settings_group_utils, fmt::format("Failed to flush response cache access times: {}", e.what()));
+	}
+}
+
+bool ResponseCache::open(const ResponseCacheOptions& options)
+{
+	std::lock_guard<std::mutex> lock(this->m_cache_mutex);
+
+	this->m_options = options;
+
+	try
+	{
+		std::filesystem::create_directories(options.path);
+
+		this->m_env = lmdb::env::create();
+		this->m_env.set_mapsize(std::max<size_t>(options.max_size_bytes * 2, 1UL * 1024UL * 1024UL));
+		this->m_env.set_max_dbs(3);
+		this->m_env.open(options.path.string().c_str(), MDB_NOSYNC | MDB_NOTLS, 0664);
+
+		auto wtxn			 = lmdb::txn::begin(this->m_env);
+		this->m_variants_dbi = lmdb::dbi::open(wtxn, "variants", MDB_CREATE);
+		this->m_entries_dbi	 = lmdb::dbi::open(wtxn, "entries", MDB_CREATE);
+		this->m_access_dbi	 = lmdb::dbi::open(wtxn, "access", MDB_CREATE);
+
+		uint64_t total_size = 0;
+		{
+			auto			 cursor = lmdb::cursor::open(wtxn, this->m_entries_dbi);
+			std::string_view key;
+			std::string_view value;
+
+			if (cursor.get(key, value, MDB_FIRST))
+			{
+				do
+				{
+					total_size += key.size() + value.size();
+				} while (cursor.get(key, value, MDB_NEXT));
+			}
+		}
+
+		wtxn.commit();
+
+		this->m_size_bytes = total_size;
+	}
+	catch (const std::exception& e)
+	{
+		SPD_ERROR_CLASS(COMMON::d_settings_group_utils, fmt::format("Failed to open response cache at {}: {}", options.path.string(), e.what()));
+		this->m_env = lmdb::env {nullptr};
+		return false;
+	}
+
+	SPD_INFO_CLASS(COMMON::d_settings_group_utils,
+				   fmt::format("Response cache opened at {} ({} bytes in use)", options.path.string(), this->m_size_bytes.load()));
+
+	this->start_writer();
+
+	return true;
+}
+
+// The cache is shared by every caller, so responses to authenticated requests are never stored or served.
+bool ResponseCache::is_cacheable(const NetworkRequest& request)
+{
+	return request.method == HttpMethod::GET && !request.bypass_cache && request.body.empty() && request.body_view.empty() &&
+		   request.range.empty() && request.download_file_path.empty() && !request.chunk_consumer && request.username.empty() &&
+		   request.password.empty() && !find_request_header(request, "authorization");
+}
+
+CachedResponse ResponseCache::lookup(const NetworkRequest& request)
+{
+	CachedResponse result;
+
+	if (!this->m_env)
+	{
+		return result;
+	}
+
+	std::string base_key = get_base_key(request);
+
+	try
+	{
+		auto			 rtxn = lmdb::txn::begin(this->m_env, nullptr, MDB_RDONLY);
+		std::string_view value;
+
+		if (!this->m_variants_dbi.get(rtxn, base_key, value))
+		{
+			++this->m_misses;
+			return result;
+		}
+
+		std::string entry_key = get_entry_key(request, decode_vary(value));
+
+		if (!this->m_entries_dbi.get(rtxn, entry_key, value))
+		{
+			++this->m_misses;
+			return result;
+		}
+
+		auto entry = decode_entry(value);
+		rtxn.abort();
+
+		if (!entry)
+		{
+			++this->m_misses;
+			return result;
+		}
+
+		uint64_t now = get_unix_time();
+
+		{
+			std::lock_guard<std::mutex> lock(this->m_cache_mutex);
+			this->m_pending_access[entry_key] = now;
+		}
+
+		result.response		 = std::move(entry->response);
+		result.etag			 = std::move(entry->etag);
+		result.last_modified = std::move(entry->last_modified);
+
+		if (!entry->must_revalidate && now < entry->expires_at)
+		{
+			result.status = CacheLookupResult::FRESH;
+			++this->m_hits;
+		}
+		else if (!result.etag.empty() || !result.last_modified.empty())
+		{
+			result.status = CacheLookupResult::STALE;
+		}
+		else
+		{
+			result.status = CacheLookupResult::MISS;
+			++this->m_misses;
+		}
+	}
+	catch (const lmdb::error& e)
+	{
+		SPD_ERROR_CLASS(COMMON::d_settings_group_utils, fmt::format("Response cache lookup failed: {}", e.what()));
+		result = CachedResponse {};
+	}
+
+	return result;
+}
+
+bool ResponseCache::is_storable(const NetworkResponse& response) const
+{
+	return this->m_env && response.error.empty() && response.http_code == 200 && response.body.size() <= this->m_options.max_entry_bytes;
+}
+
+void ResponseCache::store(const NetworkRequest& request, const NetworkResponse& response)
+{
+	if (!this->is_storable(response))
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(this->m_writer_mutex);
+
+		if (this->m_writer_running)
+		{
+			this->m_pending_stores.emplace_back(request, response);
+			this->m_writer_condition.notify_one();
+			return;
+		}
+	}
+
+	this->write_entry(request, response);
+}
+
+void ResponseCache::start_writer()
+{
+	std::lock_guard<std::mutex> lock(this->m_writer_mutex);
+
+	if (this->m_writer_running)
+	{
+		return;
+	}
+
+	this->m_writer_running = true;
+	this->m_writer_thread  = std::thread(&ResponseCache::run_writer, this);
+}
+
+void ResponseCache::stop_writer()
+{
+	{
+		std::lock_guard<std::mutex> lock(this->m_writer_mutex);
+		this->m_writer_running = false;
+	}
+
+	this->m_writer_condition.notify_all();
+
+	if (this->m_writer_thread.joinable())
+	{
+		this->m_writer_thread.join();
+	}
+}
+
+// Stores queued before the writer was stopped are still written.
+void ResponseCache::run_writer()
+{
+	std::unique_lock<std::mutex> lock(this->m_writer_mutex);
+
+	for (;;)
+	{
+		this->m_writer_condition.wait(lock, [this] { return !this->m_pending_stores.empty() || !this->m_writer_running; });
+
+		if (this->m_pending_stores.empty())
+		{
+			return;
+		}
+
+		auto pending = std::move(this->m_pending_stores);
+		this->m_pending_stores.clear();
+
+		lock.unlock();
+		for (const auto& [request, response] : pending)
+		{
+			this->write_entry(request, response);
+		}
+		lock.lock();
+	}
+}
+
+void ResponseCache::write_entry(const NetworkRequest& request, const NetworkResponse& response)
+{
+	if (!this->is_storable(response))
+	{
+		return;
+	}
+
+	CacheEntry				 entry;
+	std::vector<std::string> vary_headers;
+	std::optional<uint64_t>	 max_age;
+
+	if (auto cache_control = response.get_header("Cache-Control"))
+	{
+		for (auto directive_range : *cache_control | std::views::split(','))
+		{
+			std::string directive = to_lower(trim(std::string_view(directive_range.begin(), directive_range.end())));
+
+			if (directive == "no-store")
+			{
+				return;
+			}
+			else if (directive == "no-cache")
+			{
+				entry.must_revalidate = 1;
+			}
+			else if (directive.starts_with("max-age="))
+			{
+				max_age = std::strtoull(directive.c_str() + 8, nullptr, 10);
+			}
+		}
+	}
+
+	if (auto vary = response.get_header("Vary"))
+	{
+		for (auto header_range : *vary | std::views::split(','))
+		{
+			std::string header = to_lower(trim(std::string_view(header_range.begin(), header_range.end())));
+
+			if (header == "*")
+			{
+				return;
+			}
+			if (!header.empty())
+			{
+				vary_headers.push_back(std::move(header));
+			}
+		}
+	}
+
+	uint64_t now = get_unix_time();
+
+	if (max_age)
+	{
+		entry.expires_at = now + *max_age;
+	}
+	else if (auto expires = response.get_header("Expires"))
+	{
+		time_t expires_time = curl_getdate(std::string(*expires).c_str(), nullptr);
+		entry.expires_at	= expires_time > 0 ? static_cast<uint64_t>(expires_time) : 0;
+	}
+
+	if (auto etag = response.get_header("ETag"))
+	{
+		entry.etag = *etag;
+	}
+	if (auto last_modified = response.get_header("Last-Modified"))
+	{
+		entry.last_modified = *last_modified;
+	}
+
+	if (entry.expires_at <= now && entry.etag.empty() && entry.last_modified.empty())
+	{
+		return;
+	}
+
+	entry.response		 = response;
+	std::string base_key = get_base_key(request);
+	std::string key		 = get_entry_key(request, vary_headers);
+	std::string value	 = encode_entry(entry);
+
+	std::lock_guard<std::mutex> lock(this->m_cache_mutex);
+
+	try
+	{
+		auto			 wtxn		= lmdb::txn::begin(this->m_env);
+		uint64_t		 size_bytes = this->m_size_bytes;
+		uint64_t		 evictions	= 0;
+		std::string_view previous;
+
+		if (this->m_entries_dbi.get(wtxn, key, previous))
+		{
+			size_bytes -= std::min<uint64_t>(size_bytes, key.size() + previous.size());
+		}
+
+		this->m_variants_dbi.put(wtxn, base_key, encode_vary(vary_headers));
+		this->m_entries_dbi.put(wtxn, key, value);
+		this->m_pending_access[key] = now;
+		size_bytes += key.size() + value.size();
+
+		this->flush_access_times(wtxn);
+
+		if (size_bytes > this->m_options.max_size_bytes)
+		{
+			evictions = this->evict_lru(wtxn, size_bytes);
+		}
+
+		wtxn.commit();
+
+		this->m_size_bytes = size_bytes;
+		this->m_evictions += evictions;
+		++this->m_stores;
+	}
+	catch (const lmdb::error& e)
+	{
+		SPD_WARN_CLASS(COMMON::d_settings_group_utils, fmt::format("Unable to store response for {} in cache: {}", request.url, e.what()));
+	}
+}
+
+NetworkResponse ResponseCache::revalidate(const NetworkRequest& request, NetworkResponse cached, const NetworkResponse& not_modified)
+{
+	for (const auto& [name, value] : not_modified.headers)
+	{
+		auto iterator = std::ranges::find_if(cached.headers, [&name](const auto& header) {
+			return to_lower(header.first) == to_lower(name);
+		});
+
+		if (iterator != cached.headers.end())
+		{
+			iterator->second = value;
+		}
+		else
+		{
+			cached.headers.emplace_back(name, value);
+		}
+	}
+
+	cached.http_code = 200;
+
+	this->store(request, cached);
+	++this->m_revalidated;
+
+	return cached;
+}
+
+void ResponseCache::record_miss()
+{
+	++this->m_misses;
+}
+
+ResponseCacheStats ResponseCache::get_stats() const
+{
+	ResponseCacheStats stats;
+	stats.hits		  = this->m_hits;
+	stats.revalidated = this->m_revalidated;
+	stats.misses	  = this->m_misses;
+	stats.stores	  = this->m_stores;
+	stats.evictions	  = this->m_evictions;
+	stats.size_bytes  = this->m_size_bytes;
+	return stats;
+}
+
+std::string ResponseCache::get_base_key(const NetworkRequest& request)
+{
+	return fmt::format("GET {}", request.url);
+}
+
+std::string ResponseCache::get_entry_key(const NetworkRequest& request, const std::vector<std::string>& vary_headers)
+{
+	std::string key = get_base_key(request);
+
+	for (const auto& header : vary_headers)
+	{
+		key += '\n';
+		key += header;
+		key += '=';
+		key += find_request_header(request, header).value_or("");
+	}
+
+	return key;
+}
+
+void ResponseCache::flush_access_times(lmdb::txn& txn)
+{
+	for (const auto& [key, access_time] : this->m_pending_access)
+	{
+		std::string value;
+		append_u64(value, access_time);
+		this->m_access_dbi.put(txn, key, value);
+	}
+
+	this->m_pending_access.clear();
+}
+
+uint64_t ResponseCache::evict_lru(lmdb::txn& txn, uint64_t& size_bytes)
+{
+	uint64_t evictions = 0;
+
+	std::vector<std::pair<uint64_t, std::string>> candidates;
+
+	{
+		auto			 cursor = lmdb::cursor::open(txn, this->m_access_dbi);
+		std::string_view key;
+		std::string_view value;
+
+		if (cursor.get(key, value, MDB_FIRST))
+		{
+			do
+			{
+				uint64_t access_time = 0;
+				EntryReader(value).read_u64(access_time);
+				candidates.emplace_back(access_time, std::string(key));
+			} while (cursor.get(key, value, MDB_NEXT));
+		}
+	}
+
+	std::ranges::sort(candidates);
+
+	auto target_size = static_cast<uint64_t>(static_cast<double>(this->m_options.max_size_bytes) * EVICTION_TARGET);
+
+	for (const auto& [access_time, key] : candidates)
+	{
+		if (size_bytes <= target_size)
+		{
+			break;
+		}
+
+		std::string_view value;
+
+		if (this->m_entries_dbi.get(txn, key, value))
+		{
+			size_bytes -= std::min<uint64_t>(size_bytes, key.size() + value.size());
+			this->m_entries_dbi.del(txn, key);
+			++evictions;
+		}
+
+		this->m_access_dbi.del(txn, key);
+	}
+
+	return evictions;
+}
+} // namespace UTILS
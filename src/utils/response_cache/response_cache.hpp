@@ -0,0 +1,120 @@
+#ifndef RESPONSE_CACHE_HPP
+#define RESPONSE_CACHE_HPP
+
+#include "network_manager.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <lmdb++.h>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+namespace fs = std::filesystem;
+
+namespace UTILS
+{
+struct ResponseCacheOptions
+{
+	fs::path path			 = "./data/http-cache/";
+	size_t	 max_size_bytes	 = 64UL * 1024UL * 1024UL;
+	size_t	 max_entry_bytes = 4UL * 1024UL * 1024UL;
+};
+
+struct ResponseCacheStats
+{
+	uint64_t hits		 = 0;
+	uint64_t revalidated = 0;
+	uint64_t misses		 = 0;
+	uint64_t stores		 = 0;
+	uint64_t evictions	 = 0;
+	uint64_t size_bytes	 = 0;
+
+	double hit_ratio() const;
+};
+
+enum class CacheLookupResult
+{
+	MISS,
+	FRESH,
+	STALE
+};
+
+struct CachedResponse
+{
+	CacheLookupResult status = CacheLookupResult::MISS;
+	NetworkResponse	  response;
+	std::string		  etag;
+	std::string		  last_modified;
+};
+
+class ResponseCache
+{
+public:
+	ResponseCache() = default;
+	~ResponseCache();
+
+	ResponseCache(const ResponseCache&)			   = delete;
+	ResponseCache& operator=(const ResponseCache&) = delete;
+
+	bool open(const ResponseCacheOptions& options);
+
+	static bool is_cacheable(const NetworkRequest& request);
+
+	// Stores and revalidations are written by a background writer, so they are cheap to call from the event loop.
+	CachedResponse	lookup(const NetworkRequest& request);
+	void			store(const NetworkRequest& request, const NetworkResponse& response);
+	NetworkResponse revalidate(const NetworkRequest& request, NetworkResponse cached, const NetworkResponse& not_modified);
+	void			record_miss();
+
+	ResponseCacheStats get_stats() const;
+
+private:
+	static std::string get_base_key(const NetworkRequest& request);
+	static std::string get_entry_key(const NetworkRequest& request, const std::vector<std::string>& vary_headers);
+
+	bool is_storable(const NetworkResponse& response) const;
+	void write_entry(const NetworkRequest& request, const NetworkResponse& response);
+
+	void start_writer();
+	void stop_writer();
+	void run_writer();
+
+	void	 flush_access_times(lmdb::txn& txn);
+	uint64_t evict_lru(lmdb::txn& txn, uint64_t& size_bytes);
+
+private:
+	ResponseCacheOptions m_options;
+
+	lmdb::env m_env {nullptr};
+	lmdb::dbi m_variants_dbi;
+	lmdb::dbi m_entries_dbi;
+	lmdb::dbi m_access_dbi;
+
+	std::unordered_map<std::string, uint64_t> m_pending_access;
+
+	std::atomic<uint64_t> m_hits		= 0;
+	std::atomic<uint64_t> m_revalidated = 0;
+	std::atomic<uint64_t> m_misses		= 0;
+	std::atomic<uint64_t> m_stores		= 0;
+	std::atomic<uint64_t> m_evictions	= 0;
+	std::atomic<uint64_t> m_size_bytes	= 0;
+
+	std::thread											   m_writer_thread;
+	std::condition_variable								   m_writer_condition;
+	std::deque<std::pair<NetworkRequest, NetworkResponse>> m_pending_stores;
+	bool												   m_writer_running	= false;
+
+protected:
+	mutable std::mutex m_cache_mutex;
+	std::mutex		   m_writer_mutex;
+};
+} // namespace UTILS
+
+#endif // RESPONSE_CACHE_HPP
@@ -0,0 +1,422 @@
+#include "segmented_download.hpp"
+
+#include "spdlog_wrapper.hpp"
+
+#include <charconv>
+#include <fstream>
+#include <sstream>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+std::optional<uint64_t> parse_unsigned(std::string_view value)
+{
+	uint64_t result	  = 0;
+	auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), result);
+
+	if (error != std::errc() || end != value.data() + value.size())
+	{
+		return std::nullopt;
+	}
+
+	return result;
+}
+} // anonymous namespace
+
+namespace UTILS
+{
+SegmentedDownload::SegmentedDownload(NetworkManager& network_manager, NetworkRequest request, fs::path output_path, size_t segment_count) :
+	m_network_manager(network_manager),
+	m_request(std::move(request)),
+	m_output_path(std::move(output_path)),
+	m_segment_count(std::max<size_t>(segment_count, 1))
+{
+	this->m_request.decompress_response = false;
+}
+
+SegmentedDownload::~SegmentedDownload()
+{
+	this->close_output();
+}
+
+bool SegmentedDownload::run()
+{
+#if defined(__linux__)
+	if (this->m_segment_count == 1 || !this->probe())
+	{
+		return this->download_single();
+	}
+
+	if (!this->load_manifest())
+	{
+		this->plan_segments();
+	}
+
+	if (!this->open_output())
+	{
+		return false;
+	}
+
+	// Whatever a loaded manifest claims is already on disk.
+	this->save_manifest(this->get_progress());
+
+	bool success = this->download_segments();
+
+	if (success && fdatasync(this->m_output_fd) != 0)
+	{
+		SPD_ERROR_CLASS(COMMON::d_settings_group_utils, fmt::format("Failed to flush {}: {}", this->m_output_path.string(), std::strerror(errno)));
+		success = false;
+	}
+
+	if (!success)
+	{
+		this->checkpoint();
+	}
+
+	this->close_output();
+
+	if (!success)
+	{
+		SPD_WARN_CLASS(COMMON::d_settings_group_utils,
+					   fmt::format("Segmented download of {} interrupted, progress kept in {}",
+								   this->m_request.url,
+								   this->get_manifest_path().string()));
+		return false;
+	}
+
+	std::error_code error;
+	fs::remove(this->get_manifest_path(), error);
+
+	return true;
+#else
+	return this->download_single();
+#endif
+}
+
+bool SegmentedDownload::download_single()
+{
+	NetworkRequest request	   = this->m_request;
+	request.download_file_path = this->m_output_path.string();
+
+	NetworkResponse response = this->m_network_manager.make_request(request);
+	return response.error.empty() && response.http_code >= 200 && response.http_code < 300;
+}
+
+bool SegmentedDownload::probe()
+{
+	NetworkRequest request = this->m_request;
+	request.method		   = HttpMethod::HEAD;
+
+	NetworkResponse response = this->m_network_manager.make_request(request);
+
+	if (!response.error.empty() || response.http_code < 200 || response.http_code >= 300)
+	{
+		return false;
+	}
+
+	auto accept_ranges	= response.get_header("Accept-Ranges");
+	auto content_length = response.get_header("Content-Length");
+
+	if (!accept_ranges || accept_ranges->find("bytes") == std::string_view::npos || !content_length)
+	{
+		SPD_DEBUG_CLASS(COMMON::d_settings_group_utils, fmt::format("Server does not support ranged downloads for {}", this->m_request.url));
+		return false;
+	}
+
+	auto length = parse_unsigned(*content_length);
+
+	if (!length || *length < this->m_segment_count)
+	{
+		return false;
+	}
+
+	this->m_content_length = *length;
+
+	if (auto etag = response.get_header("ETag"))
+	{
+		this->m_validator = *etag;
+	}
+	else if (auto last_modified = response.get_header("Last-Modified"))
+	{
+		this->m_validator = *last_modified;
+	}
+
+	return true;
+}
+
+void SegmentedDownload::plan_segments()
+{
+	this->m_segments.clear();
+
+	uint64_t segment_size = this->m_content_length / this->m_segment_count;
+
+	for (size_t i = 0; i < this->m_segment_count; ++i)
+	{
+		auto segment   = std::make_unique<Segment>();
+		segment->begin = i * segment_size;
+		segment->end   = (i + 1 == this->m_segment_count) ? this->m_content_length - 1 : (i + 1) * segment_size - 1;
+		this->m_segments.push_back(std::move(segment));
+	}
+}
+
+bool SegmentedDownload::open_output()
+{
+#if defined(__linux__)
+	this->m_output_fd = open(this->m_output_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+
+	if (this->m_output_fd < 0)
+	{
+		SPD_ERROR_CLASS(COMMON::d_settings_group_utils,
+						fmt::format("Failed to open file for writing: {}: {}", this->m_output_path.string(), std::strerror(errno)));
+		return false;
+	}
+
+	auto length = static_cast<off_t>(this->m_content_length);
+
+	// Truncating also cuts off the tail of a longer file that is being replaced.
+	if (ftruncate(this->m_output_fd, length) != 0)
+	{
+		SPD_ERROR_CLASS(COMMON::d_settings_group_utils,
+						fmt::format("Failed to resize {} to {} bytes: {}", this->m_output_path.string(), length, std::strerror(errno)));
+		this->close_output();
+		return false;
+	}
+
+	// Reserving the blocks up front is only an optimization, file systems without support stay sparse.
+	[[maybe_unused]] auto allocated = fallocate(this->m_output_fd, 0, 0, length);
+
+	return true;
+#else
+	return false;
+#endif
+}
+
+void SegmentedDownload::close_output()
+{
+#if defined(__linux__)
+	if (this->m_output_fd >= 0)
+	{
+		close(this->m_output_fd);
+		this->m_output_fd = -1;
+	}
+#endif
+}
+
+bool SegmentedDownload::download_segments()
+{
+#if defined(__linux__)
+	std::vector<std::future<NetworkResponse>> futures;
+	std::vector<Segment*>					  segments;
+
+	for (auto& segment : this->m_segments)
+	{
+		uint64_t offset = segment->begin + segment->completed;
+
+		if (offset > segment->end)
+		{
+			continue;
+		}
+
+		NetworkRequest request = this->m_request;
+		request.range		   = fmt::format("{}-{}", offset, segment->end);
+		request.chunk_consumer = [fd = this->m_output_fd, target = segment.get()](std::span<const std::byte> chunk) {
+			uint64_t position = target->begin + target->completed;
+
+			if (position + chunk.size() > target->end + 1)
+			{
+				return ChunkResult::ABORT;
+			}
+
+			while (!chunk.empty())
+			{
+				ssize_t written = pwrite(fd, chunk.data(), chunk.size(), static_cast<off_t>(position));
+
+				if (written < 0)
+				{
+					if (errno == EINTR)
+					{
+						continue;
+					}
+					return ChunkResult::ABORT;
+				}
+
+				position		  += static_cast<uint64_t>(written);
+				target->completed += static_cast<uint64_t>(written);
+				chunk			   = chunk.subspan(static_cast<size_t>(written));
+			}
+
+			return ChunkResult::CONTINUE;
+		};
+
+		futures.push_back(this->m_network_manager.make_request_async(std::move(request)));
+		segments.push_back(segment.get());
+	}
+
+	SPD_DEBUG_CLASS(COMMON::d_settings_group_utils,
+					fmt::format("Downloading {} in {} segments ({} bytes)", this->m_request.url, futures.size(), this->m_content_length));
+
+	for (auto& future : futures)
+	{
+		while (future.wait_for(std::chrono::seconds(1)) != std::future_status::ready)
+		{
+			this->checkpoint();
+		}
+	}
+
+	bool success = true;
+
+	for (size_t i = 0; i < futures.size(); ++i)
+	{
+		NetworkResponse response = futures[i].get();
+		Segment*		segment	 = segments[i];
+
+		if (!response.error.empty() || response.http_code != 206 || segment->completed != segment->size())
+		{
+			SPD_ERROR_CLASS(COMMON::d_settings_group_utils,
+							fmt::format("Segment {}-{} of {} failed with HTTP code {}: {}",
+										segment->begin,
+										segment->end,
+										this->m_request.url,
+										response.http_code,
+										response.error));
+			success = false;
+		}
+	}
+
+	return success;
+#else
+	return false;
+#endif
+}
+
+bool SegmentedDownload::load_manifest()
+{
+	std::ifstream file(this->get_manifest_path());
+
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	std::string							  line;
+	std::string							  url;
+	std::string							  validator;
+	uint64_t							  content_length = 0;
+	std::vector<std::unique_ptr<Segment>> segments;
+
+	while (std::getline(file, line))
+	{
+		std::istringstream stream(line);
+		std::string		   key;
+		stream >> key;
+
+		if (key == "url")
+		{
+			stream >> url;
+		}
+		else if (key == "length")
+		{
+			stream >> content_length;
+		}
+		else if (key == "validator")
+		{
+			std::getline(stream >> std::ws, validator);
+		}
+		else if (key == "segment")
+		{
+			auto	 segment   = std::make_unique<Segment>();
+			uint64_t completed = 0;
+			stream >> segment->begin >> segment->end >> completed;
+			segment->completed = std::min(completed, segment->size());
+			segments.push_back(std::move(segment));
+		}
+	}
+
+	if (url != this->m_request.url || content_length != this->m_content_length || validator != this->m_validator || segments.empty())
+	{
+		SPD_DEBUG_CLASS(COMMON::d_settings_group_utils, fmt::format("Discarding stale download manifest {}", this->get_manifest_path().string()));
+		return false;
+	}
+
+	SPD_INFO_CLASS(COMMON::d_settings_group_utils, fmt::format("Resuming download of {}", this->m_request.url));
+
+	this->m_segments = std::move(segments);
+	return true;
+}
+
+std::vector<uint64_t> SegmentedDownload::get_progress() const
+{
+	std::vector<uint64_t> progress;
+	progress.reserve(this->m_segments.size());
+
+	for (const auto& segment : this->m_segments)
+	{
+		progress.push_back(segment->completed);
+	}
+
+	return progress;
+}
+
+// The progress is read before syncing, so the manifest never claims bytes that were written after the
+// sync and might not be on disk yet. A failed sync keeps the previous manifest.
+bool SegmentedDownload::checkpoint() const
+{
+#if defined(__linux__)
+	auto progress = this->get_progress();
+
+	if (fdatasync(this->m_output_fd) != 0)
+	{
+		SPD_DEBUG_CLASS(COMMON::d_settings_group_utils, fmt::format("Failed to flush {}: {}", this->m_output_path.string(), std::strerror(errno)));
+		return false;
+	}
+
+	return this->save_manifest(progress);
+#else
+	return false;
+#endif
+}
+
+bool SegmentedDownload::save_manifest(const std::vector<uint64_t>& progress) const
+{
+	fs::path manifest_path = this->get_manifest_path();
+	fs::path temp_path	   = manifest_path;
+	temp_path += ".tmp";
+
+	{
+		std::ofstream file(temp_path, std::ios::out | std::ios::trunc);
+
+		if (!file.is_open())
+		{
+			SPD_ERROR_CLASS(COMMON::d_settings_group_utils, fmt::format("Failed to write download manifest: {}", temp_path.string()));
+			return false;
+		}
+
+		file << "url " << this->m_request.url << '\n';
+		file << "length " << this->m_content_length << '\n';
+		file << "validator " << this->m_validator << '\n';
+
+		for (size_t i = 0; i < this->m_segments.size(); ++i)
+		{
+			file << "segment " << this->m_segments[i]->begin << ' ' << this->m_segments[i]->end << ' ' << progress[i] << '\n';
+		}
+	}
+
+	std::error_code error;
+	fs::rename(temp_path, manifest_path, error);
+
+	return !error;
+}
+
+fs::path SegmentedDownload::get_manifest_path() const
+{
+	fs::path manifest_path = this->m_output_path;
+	manifest_path += ".part";
+	return manifest_path;
+}
+} // namespace UTILS
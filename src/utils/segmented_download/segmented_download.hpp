@@ -0,0 +1,69 @@
+#ifndef SEGMENTED_DOWNLOAD_HPP
+#define SEGMENTED_DOWNLOAD_HPP
+
+#include "network_manager.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace UTILS
+{
+class SegmentedDownload
+{
+public:
+	SegmentedDownload(NetworkManager& network_manager, NetworkRequest request, fs::path output_path, size_t segment_count);
+	~SegmentedDownload();
+
+	SegmentedDownload(const SegmentedDownload&)			   = delete;
+	SegmentedDownload& operator=(const SegmentedDownload&) = delete;
+
+	bool run();
+
+private:
+	struct Segment
+	{
+		uint64_t			  begin		= 0;
+		uint64_t			  end		= 0;
+		std::atomic<uint64_t> completed = 0;
+
+		uint64_t size() const
+		{
+			return end - begin + 1;
+		}
+	};
+
+	bool download_single();
+	bool probe();
+	void plan_segments();
+	bool open_output();
+	void close_output();
+	bool download_segments();
+
+	std::vector<uint64_t> get_progress() const;
+	bool				  checkpoint() const;
+
+	bool	 load_manifest();
+	bool	 save_manifest(const std::vector<uint64_t>& progress) const;
+	fs::path get_manifest_path() const;
+
+private:
+	NetworkManager& m_network_manager;
+	NetworkRequest	m_request;
+	fs::path		m_output_path;
+	size_t			m_segment_count;
+
+	uint64_t	m_content_length = 0;
+	std::string m_validator;
+	int			m_output_fd = -1;
+
+	std::vector<std::unique_ptr<Segment>> m_segments;
+};
+} // namespace UTILS
+
+#endif // SEGMENTED_DOWNLOAD_HPP
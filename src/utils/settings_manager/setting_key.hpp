@@ -0,0 +1,97 @@
+#ifndef SETTING_KEY_HPP
+#define SETTING_KEY_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace UTILS
+{
+// String literal usable as a template argument.
+template<size_t N>
+struct SettingPath
+{
+	char value[N] = {};
+
+	constexpr SettingPath(const char (&path)[N])
+	{
+		std::copy_n(path, N, this->value);
+	}
+
+	constexpr std::string_view view() const
+	{
+		return std::string_view(this->value, N - 1);
+	}
+};
+
+namespace DETAIL
+{
+constexpr bool is_valid_setting_path(std::string_view path)
+{
+	if (path.empty() || path.front() == '.' || path.back() == '.')
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < path.size(); ++i)
+	{
+		char character = path[i];
+
+		if (character == '.' && path[i + 1] == '.')
+		{
+			return false;
+		}
+
+		bool is_letter = (character >= 'a' && character <= 'z') || (character >= 'A' && character <= 'Z');
+		bool is_digit  = character >= '0' && character <= '9';
+		if (!is_letter && !is_digit && character != '.' && character != '_' && character != '-')
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+constexpr uint64_t hash_setting_path(std::string_view path)
+{
+	uint64_t hash = 14695981039346656037ULL;
+
+	for (char character : path)
+	{
+		hash ^= static_cast<unsigned char>(character);
+		hash *= 1099511628211ULL;
+	}
+
+	return hash;
+}
+
+// Path whose hash is already known, looked up without hashing it again.
+struct HashedSettingPath
+{
+	std::string_view path;
+	uint64_t		 hash = 0;
+
+	friend constexpr bool operator==(std::string_view other, const HashedSettingPath& hashed)
+	{
+		return other == hashed.path;
+	}
+};
+} // namespace DETAIL
+
+// Typed, compile-time checked settings path, e.g. SettingKey<int64_t, "notifications.workers">.
+// The path is validated and hashed at compile time.
+template<typename T, SettingPath Path>
+struct SettingKey
+{
+	static_assert(DETAIL::is_valid_setting_path(Path.view()), "Setting paths are dot separated keys of [A-Za-z0-9_-].");
+
+	using value_type = T;
+
+	static constexpr std::string_view		   path		   = Path.view();
+	static constexpr DETAIL::HashedSettingPath hashed_path = {path, DETAIL::hash_setting_path(path)};
+};
+} // namespace UTILS
+
+#endif // SETTING_KEY_HPP
@@ -0,0 +1,328 @@
+#include "settings_cache.hpp"
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+constexpr char	   CACHE_MAGIC[8] = {'S', 'E', 'T', 'C', 'A', 'C', 'H', 'E'};
+constexpr uint32_t CACHE_VERSION  = 1;
+constexpr uint32_t ROOT_PARENT	  = std::numeric_limits<uint32_t>::max();
+
+enum class EntryType : uint32_t
+{
+	TABLE,
+	ARRAY,
+	STRING,
+	INTEGER,
+	FLOATING_POINT,
+	BOOLEAN
+};
+
+struct CacheHeader
+{
+	char	 magic[8];
+	uint32_t version;
+	uint32_t entry_count;
+	int64_t	 source_time;
+	uint64_t source_size;
+	uint64_t source_hash;
+	uint64_t strings_size;
+};
+
+// Parents are stored before their children, so the tree is rebuilt in a single pass. Keys and string
+// values point into the string area that follows the entries.
+struct CacheEntry
+{
+	uint32_t  parent;
+	EntryType type;
+	uint32_t  key_offset;
+	uint32_t  key_size;
+	uint32_t  string_offset;
+	uint32_t  string_size;
+	uint64_t  value;
+};
+
+uint64_t hash_bytes(std::span<const std::byte> bytes)
+{
+	uint64_t hash = 14695981039346656037ULL;
+
+	for (std::byte byte : bytes)
+	{
+		hash ^= static_cast<uint64_t>(byte);
+		hash *= 1099511628211ULL;
+	}
+
+	return hash;
+}
+
+int64_t get_time_count(fs::file_time_type time)
+{
+	return static_cast<int64_t>(time.time_since_epoch().count());
+}
+
+struct CacheWriter
+{
+	std::vector<CacheEntry> entries;
+	std::string				strings;
+
+	bool add_string(std::string_view value, uint32_t &offset, uint32_t &size)
+	{
+		if (this->strings.size() + value.size() > std::numeric_limits<uint32_t>::max())
+		{
+			return false;
+		}
+
+		offset = static_cast<uint32_t>(this->strings.size());
+		size   = static_cast<uint32_t>(value.size());
+		this->strings.append(value);
+
+		return true;
+	}
+
+	bool add_node(uint32_t parent, std::string_view key, const toml::node &node)
+	{
+		CacheEntry entry {};
+		entry.parent = parent;
+
+		if (!this->add_string(key, entry.key_offset, entry.key_size))
+		{
+			return false;
+		}
+
+		switch (node.type())
+		{
+			case toml::node_type::table:
+				entry.type = EntryType::TABLE;
+				break;
+			case toml::node_type::array:
+				entry.type = EntryType::ARRAY;
+				break;
+			case toml::node_type::string:
+				entry.type = EntryType::STRING;
+				if (!this->add_string(node.as_string()->get(), entry.string_offset, entry.string_size))
+				{
+					return false;
+				}
+				break;
+			case toml::node_type::integer:
+				entry.type	= EntryType::INTEGER;
+				entry.value = static_cast<uint64_t>(node.as_integer()->get());
+				break;
+			case toml::node_type::floating_point:
+				entry.type	= EntryType::FLOATING_POINT;
+				entry.value = std::bit_cast<uint64_t>(node.as_floating_point()->get());
+				break;
+			case toml::node_type::boolean:
+				entry.type	= EntryType::BOOLEAN;
+				entry.value = node.as_boolean()->get() ? 1 : 0;
+				break;
+			default:
+				return false;
+		}
+
+		if (this->entries.size() >= ROOT_PARENT)
+		{
+			return false;
+		}
+
+		auto index = static_cast<uint32_t>(this->entries.size());
+		this->entries.push_back(entry);
+
+		if (const auto *table = node.as_table())
+		{
+			return this->add_children(index, *table);
+		}
+
+		if (const auto *array = node.as_array())
+		{
+			for (const auto &element : *array)
+			{
+				if (!this->add_node(index, {}, element))
+				{
+					return false;
+				}
+			}
+		}
+
+		return true;
+	}
+
+	bool add_children(uint32_t parent, const toml::table &table)
+	{
+		for (auto &&[key, node] : table)
+		{
+			if (!this->add_node(parent, key.str(), node))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+};
+
+// Only tables and arrays are recorded as parents, so the parent is always one or the other.
+template<typename V>
+toml::node *insert_value(toml::node &parent, std::string_view key, V &&value)
+{
+	if (auto *table = parent.as_table())
+	{
+		return &table->insert_or_assign(key, std::forward<V>(value)).first->second;
+	}
+
+	auto *array = parent.as_array();
+	array->push_back(std::forward<V>(value));
+
+	return &array->back();
+}
+} // anonymous namespace
+
+namespace UTILS
+{
+fs::path get_settings_cache_path(const fs::path &file_path)
+{
+	fs::path cache_path = file_path;
+	cache_path += ".cache";
+	return cache_path;
+}
+
+bool encode_settings_cache(const toml::table &config, std::span<const std::byte> source, fs::file_time_type source_time, std::string &output)
+{
+	CacheWriter writer;
+
+	if (!writer.add_children(ROOT_PARENT, config))
+	{
+		return false;
+	}
+
+	CacheHeader header {};
+	std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+	header.version		= CACHE_VERSION;
+	header.entry_count	= static_cast<uint32_t>(writer.entries.size());
+	header.source_time	= get_time_count(source_time);
+	header.source_size	= source.size();
+	header.source_hash	= hash_bytes(source);
+	header.strings_size = writer.strings.size();
+
+	output.clear();
+	output.reserve(sizeof(header) + writer.entries.size() * sizeof(CacheEntry) + writer.strings.size());
+	output.append(reinterpret_cast<const char *>(&header), sizeof(header));
+	output.append(reinterpret_cast<const char *>(writer.entries.data()), writer.entries.size() * sizeof(CacheEntry));
+	output.append(writer.strings);
+
+	return true;
+}
+
+bool decode_settings_cache(std::span<const std::byte> cache, std::span<const std::byte> source, fs::file_time_type source_time, toml::table &config)
+{
+	CacheHeader header;
+
+	if (cache.size() < sizeof(header))
+	{
+		return false;
+	}
+
+	std::memcpy(&header, cache.data(), sizeof(header));
+
+	if (std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 || header.version != CACHE_VERSION)
+	{
+		return false;
+	}
+
+	// The modification time rules out most stale caches before the source has to be hashed.
+	if (header.source_time != get_time_count(source_time) || header.source_size != source.size())
+	{
+		return false;
+	}
+
+	uint64_t entries_size = static_cast<uint64_t>(header.entry_count) * sizeof(CacheEntry);
+
+	if (cache.size() - sizeof(header) < entries_size || cache.size() - sizeof(header) - entries_size != header.strings_size)
+	{
+		return false;
+	}
+
+	if (header.source_hash != hash_bytes(source))
+	{
+		return false;
+	}
+
+	const std::byte *entries = cache.data() + sizeof(header);
+	std::string_view strings(reinterpret_cast<const char *>(entries + entries_size), header.strings_size);
+
+	auto get_string = [&strings](uint32_t offset, uint32_t size, std::string_view &value) {
+		if (static_cast<uint64_t>(offset) + size > strings.size())
+		{
+			return false;
+		}
+
+		value = strings.substr(offset, size);
+		return true;
+	};
+
+	toml::table				  result;
+	std::vector<toml::node *> containers(header.entry_count, nullptr);
+
+	for (uint32_t i = 0; i < header.entry_count; ++i)
+	{
+		CacheEntry entry;
+		std::memcpy(&entry, entries + static_cast<size_t>(i) * sizeof(CacheEntry), sizeof(entry));
+
+		std::string_view key;
+		if (!get_string(entry.key_offset, entry.key_size, key))
+		{
+			return false;
+		}
+
+		toml::node *parent = &result;
+		if (entry.parent != ROOT_PARENT)
+		{
+			if (entry.parent >= i || !containers[entry.parent])
+			{
+				return false;
+			}
+
+			parent = containers[entry.parent];
+		}
+
+		switch (entry.type)
+		{
+			case EntryType::TABLE:
+				containers[i] = insert_value(*parent, key, toml::table {});
+				break;
+			case EntryType::ARRAY:
+				containers[i] = insert_value(*parent, key, toml::array {});
+				break;
+			case EntryType::STRING: {
+				std::string_view value;
+				if (!get_string(entry.string_offset, entry.string_size, value))
+				{
+					return false;
+				}
+				insert_value(*parent, key, std::string(value));
+				break;
+			}
+			case EntryType::INTEGER:
+				insert_value(*parent, key, static_cast<int64_t>(entry.value));
+				break;
+			case EntryType::FLOATING_POINT:
+				insert_value(*parent, key, std::bit_cast<double>(entry.value));
+				break;
+			case EntryType::BOOLEAN:
+				insert_value(*parent, key, entry.value != 0);
+				break;
+			default:
+				return false;
+		}
+	}
+
+	config = std::move(result);
+
+	return true;
+}
+} // namespace UTILS
@@ -0,0 +1,27 @@
+#ifndef SETTINGS_CACHE_HPP
+#define SETTINGS_CACHE_HPP
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <toml++/toml.hpp>
+
+namespace fs = std::filesystem;
+
+namespace UTILS
+{
+// Binary copy of a parsed settings file, stored as a flat list of typed entries that is read in place.
+// A cache is only accepted while the modification time and the content hash of its source still match,
+// everything else falls back to parsing the TOML file.
+fs::path get_settings_cache_path(const fs::path& file_path);
+
+// Fails for values the cache cannot represent, such as dates and times.
+bool encode_settings_cache(const toml::table& config, std::span<const std::byte> source, fs::file_time_type source_time, std::string& output);
+bool decode_settings_cache(std::span<const std::byte> cache,
+						   std::span<const std::byte> source,
+						   fs::file_time_type		  source_time,
+						   toml::table&				  config);
+} // namespace UTILS
+
+#endif // SETTINGS_CACHE_HPP
@@ -1,11 +1,25 @@
 #include "settings_manager.hpp"
 
+#include "mapped_file.hpp"
+#include "settings_cache.hpp"
 #include "spdlog_wrapper.hpp"
 
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
 #include <filesystem>
+#include <fstream>
 #include <memory>
+#include <sstream>
 #include <toml++/impl/table.hpp>
 
+#if !defined(_WIN32) && !defined(WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+
+extern char **environ;
+#endif
+
 namespace
 {
 std::string getenv_safe(const char *name)
@@ -14,6 +28,9 @@ std::string getenv_safe(const char *name)
 	return value ? value : "";
 }
 
+// The subscription whose callback runs on this thread, see unsubscribe.
+thread_local const void *t_notifying_subscription = nullptr;
+
 const std::string DEFAULT_CONFIG_FILE_NAME = std::string(COMMON::d_project_name) + ".toml";
 
 const std::vector<fs::path> DEFAULT_CONFIG_PATHS = [] {
@@ -48,25 +65,289 @@ const std::vector<fs::path> DEFAULT_CONFIG_PATHS = [] {
 	return paths;
 }();
 
+const fs::path SYSTEM_CONFIG_PATH = [] {
+#if defined(_WIN32) || defined(WIN32)
+	std::string program_data = getenv_safe("PROGRAMDATA");
+	if (program_data.empty())
+	{
+		return fs::path();
+	}
+	return fs::path(program_data) / COMMON::d_project_name / DEFAULT_CONFIG_FILE_NAME;
+#elif defined(__APPLE__) && defined(__MACH__)
+	return fs::path("/Library/Application Support") / COMMON::d_project_name / DEFAULT_CONFIG_FILE_NAME;
+#else
+	return fs::path("/etc") / COMMON::d_project_name / DEFAULT_CONFIG_FILE_NAME;
+#endif
+}();
+
+// APPNAME_NOTIFICATIONS__RATE_BURST sets notifications.rate_burst, a double underscore separates tables.
+const std::string ENVIRONMENT_PREFIX = [] {
+	std::string prefix(COMMON::d_project_name);
+
+	for (char &character : prefix)
+	{
+		auto code = static_cast<unsigned char>(character);
+		character = std::isalnum(code) ? static_cast<char>(std::toupper(code)) : '_';
+	}
+
+	return prefix + "_";
+}();
+
 static constexpr std::string_view default_toml_format = R"(
     [application]
     name = "{project_name}"
     authors = ["{developer_name} <{developer_email}>"]
+    [settings]
+    hot_reload = true
+    reload_debounce_ms = 250
+    save_delay_ms = 100
+    binary_cache = true
     [notifications]
     enabled = false
     uri = ""
     username = ""
     password = ""
+    workers = 2
+    max_in_flight = 16
+    queue_capacity = 1024
+    overflow_policy = "block"
+    coalesce_window_ms = 5000
+    coalesce_max_count = 100
+    dedup_window_ms = 10000
+    rate_per_minute = 60
+    rate_burst = 10
+    outbox_enabled = false
+    outbox_path = "./data/notification-outbox/"
+    outbox_max_attempts = 10
 )";
 
 std::string default_toml = fmt::format(default_toml_format,
 									   fmt::arg("project_name", COMMON::d_project_name),
 									   fmt::arg("developer_name", COMMON::d_developer_name),
 									   fmt::arg("developer_email", COMMON::d_developer_email));
+
+// Values only, tables are compared key by key in diff_tables.
+bool nodes_equal(const toml::node &lhs, const toml::node &rhs)
+{
+	if (lhs.type() != rhs.type())
+	{
+		return false;
+	}
+
+	switch (lhs.type())
+	{
+		case toml::node_type::array:
+			return *lhs.as_array() == *rhs.as_array();
+		case toml::node_type::string:
+			return *lhs.as_string() == *rhs.as_string();
+		case toml::node_type::integer:
+			return *lhs.as_integer() == *rhs.as_integer();
+		case toml::node_type::floating_point:
+			return *lhs.as_floating_point() == *rhs.as_floating_point();
+		case toml::node_type::boolean:
+			return *lhs.as_boolean() == *rhs.as_boolean();
+		case toml::node_type::date:
+			return *lhs.as_date() == *rhs.as_date();
+		case toml::node_type::time:
+			return *lhs.as_time() == *rhs.as_time();
+		case toml::node_type::date_time:
+			return *lhs.as_date_time() == *rhs.as_date_time();
+		default:
+			return true;
+	}
+}
+
+// Tables are merged key by key, anything else replaces what the earlier source had.
+void merge_tables(toml::table &target, const toml::table &source)
+{
+	for (auto &&[key, node] : source)
+	{
+		toml::node *existing = target.get(key.str());
+
+		if (existing && existing->is_table() && node.is_table())
+		{
+			merge_tables(*existing->as_table(), *node.as_table());
+		}
+		else
+		{
+			target.insert_or_assign(key.str(), node);
+		}
+	}
+}
+
+// Calls back with the full path of every value, arrays count as values.
+template<typename Callback>
+void for_each_value(const toml::table &table, const std::string &prefix, Callback &&callback)
+{
+	for (auto &&[key, node] : table)
+	{
+		std::string path = prefix.empty() ? std::string(key.str()) : fmt::format("{}.{}", prefix, key.str());
+
+		if (const toml::table *child = node.as_table())
+		{
+			for_each_value(*child, path, callback);
+		}
+		else
+		{
+			callback(path, node);
+		}
+	}
+}
+
+std::string format_value(const toml::node &node)
+{
+	std::ostringstream stream;
+
+	switch (node.type())
+	{
+		case toml::node_type::string:
+			stream << '"' << node.as_string()->get() << '"';
+			break;
+		case toml::node_type::integer:
+			stream << node.as_integer()->get();
+			break;
+		case toml::node_type::floating_point:
+			stream << node.as_floating_point()->get();
+			break;
+		case toml::node_type::boolean:
+			stream << (node.as_boolean()->get() ? "true" : "false");
+			break;
+		case toml::node_type::array:
+			stream << *node.as_array();
+			break;
+		case toml::node_type::date:
+			stream << node.as_date()->get();
+			break;
+		case toml::node_type::time:
+			stream << node.as_time()->get();
+			break;
+		case toml::node_type::date_time:
+			stream << node.as_date_time()->get();
+			break;
+		default:
+			break;
+	}
+
+	return stream.str();
+}
+
+// Writes next to the target and renames over it, so the file holds either the old or the new contents
+// even if the process dies halfway through. The result gets the permissions of permissions_path, which
+// defaults to the target itself. Failures are left to the caller to report.
+bool write_file_atomically(const fs::path  &file_path,
+						   std::string_view	contents,
+						   std::error_code &failure,
+						   const fs::path  &permissions_path = {})
+{
+	fs::path		temp_path = file_path;
+	std::error_code error;
+
+	temp_path += ".tmp";
+
+#if defined(_WIN32) || defined(WIN32)
+	{
+		std::ofstream file(temp_path, std::ios::out | std::ios::trunc | std::ios::binary);
+		file.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+		file.flush();
+
+		if (!file)
+		{
+			failure = std::make_error_code(std::errc::io_error);
+			return false;
+		}
+	}
+#else
+	// Owner only until the final permissions are applied, the contents may hold credentials.
+	int descriptor = open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+
+	if (descriptor < 0)
+	{
+		failure = std::error_code(errno, std::generic_category());
+		return false;
+	}
+
+	size_t written = 0;
+	while (written < contents.size())
+	{
+		ssize_t result = write(descriptor, contents.data() + written, contents.size() - written);
+		if (result < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		if (result < 0)
+		{
+			break;
+		}
+		written += static_cast<size_t>(result);
+	}
+
+	bool synced		= written == contents.size() && fsync(descriptor) == 0;
+	int	 sync_error = errno;
+	close(descriptor);
+
+	if (!synced)
+	{
+		failure = std::error_code(sync_error, std::generic_category());
+		fs::remove(temp_path, error);
+		return false;
+	}
+#endif
+
+	// The settings may hold credentials, keep whatever permissions the user gave the file.
+	const fs::path &reference_path = permissions_path.empty() ? file_path : permissions_path;
+	if (fs::exists(reference_path, error))
+	{
+		fs::permissions(temp_path, fs::status(reference_path, error).permissions(), error);
+	}
+	else
+	{
+		fs::permissions(temp_path, fs::perms::owner_read | fs::perms::owner_write | fs::perms::group_read | fs::perms::others_read, error);
+	}
+
+	fs::rename(temp_path, file_path, failure);
+
+	if (failure)
+	{
+		fs::remove(temp_path, error);
+		return false;
+	}
+
+#if !defined(_WIN32) && !defined(WIN32)
+	// Persists the rename itself.
+	int directory = open(file_path.parent_path().c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	if (directory >= 0)
+	{
+		fsync(directory);
+		close(directory);
+	}
+#endif
+
+	return true;
+}
 } // anonymous namespace
 
 namespace UTILS
 {
+std::string_view get_setting_source_name(SettingSource source)
+{
+	switch (source)
+	{
+		case SettingSource::DEFAULTS:
+			return "defaults";
+		case SettingSource::SYSTEM:
+			return "system";
+		case SettingSource::USER:
+			return "user";
+		case SettingSource::PROJECT:
+			return "project";
+		case SettingSource::ENVIRONMENT:
+			return "environment";
+		case SettingSource::COMMAND_LINE:
+			return "command line";
+	}
+
+	return "unknown";
+}
 
 std::string_view SettingsManager::get_manager_name() const
 {
@@ -77,7 +358,7 @@ void SettingsManager::initialize()
 {
 	try
 	{
-		m_config_default = std::make_unique<toml::table>(toml::parse(default_toml));
+		m_config_default = std::make_shared<toml::table>(toml::parse(default_toml));
 	}
 	catch (const toml::parse_error &err)
 	{
@@ -85,10 +366,50 @@ void SettingsManager::initialize()
 		return;
 	}
 
+	this->replace_layer(SettingSource::DEFAULTS, this->m_config_default, "built-in");
+	this->load_layer(SettingSource::SYSTEM, SYSTEM_CONFIG_PATH);
+	this->replace_layer(SettingSource::ENVIRONMENT, this->read_environment(), ENVIRONMENT_PREFIX + "*");
+
 	if (!this->load_settings())
 	{
 		this->create_default_settings();
 	}
+
+	// The working directory may already have provided the user settings.
+	std::error_code error;
+	auto			project_path = fs::current_path() / DEFAULT_CONFIG_FILE_NAME;
+	if (!fs::equivalent(project_path, this->m_config_path, error))
+	{
+		this->load_layer(SettingSource::PROJECT, project_path);
+	}
+
+	if (this->get_setting<bool>("settings.hot_reload", true))
+	{
+		this->start_watching();
+	}
+
+	this->start_writer();
+}
+
+void SettingsManager::start_watching()
+{
+	fs::path config_path;
+	{
+		std::lock_guard<std::mutex> lock(m_settings_mutex);
+		config_path = this->m_config_path;
+	}
+
+	if (config_path.empty())
+	{
+		return;
+	}
+
+	auto debounce = std::max<int64_t>(this->get_setting<int64_t>("settings.reload_debounce_ms", 250), 0);
+
+	if (this->m_config_watcher.start(config_path, std::chrono::milliseconds(debounce), [this] { this->reload_settings(); }))
+	{
+		SPD_DEBUG_CLASS(COMMON::d_settings_group_utils, fmt::format("Watching {} for changes.", config_path.string()));
+	}
 }
 
 void SettingsManager::create_default_settings()
@@ -124,6 +445,397 @@ std::vector<std::string_view> SettingsManager::split_path(std::string_view path)
 	return keys;
 }
 
+std::shared_ptr<SettingsManager::Snapshot> SettingsManager::build_snapshot(const Snapshot					 *current,
+																		   SettingSource					  source,
+																		   std::shared_ptr<const toml::table> config,
+																		   std::string						  location)
+{
+	auto snapshot = std::make_shared<Snapshot>();
+
+	if (current)
+	{
+		snapshot->layers = current->layers;
+	}
+
+	snapshot->layers[std::to_underlying(source)] = Layer {std::move(config), std::move(location)};
+
+	for (const auto &layer : snapshot->layers)
+	{
+		if (layer.config)
+		{
+			merge_tables(snapshot->config, *layer.config);
+		}
+	}
+
+	for_each_value(snapshot->config, "", [&snapshot](const std::string &path, const toml::node &node) {
+		snapshot->settings.emplace(path, ResolvedSetting {&node, SettingSource::DEFAULTS});
+	});
+
+	// Later layers overwrite the source of the values they set, leaving the source that won the merge.
+	for (size_t i = 0; i < SOURCE_COUNT; ++i)
+	{
+		if (!snapshot->layers[i].config)
+		{
+			continue;
+		}
+
+		for_each_value(*snapshot->layers[i].config, "", [&snapshot, i](const std::string &path, const toml::node &) {
+			if (auto setting = snapshot->settings.find(path); setting != snapshot->settings.end())
+			{
+				setting->second.source = static_cast<SettingSource>(i);
+			}
+		});
+	}
+
+	return snapshot;
+}
+
+void SettingsManager::replace_layer(SettingSource source, std::shared_ptr<const toml::table> config, std::string location)
+{
+	std::unique_lock<std::mutex> lock(m_settings_mutex);
+
+	auto current  = this->m_snapshot.load(std::memory_order_acquire);
+	auto snapshot = this->build_snapshot(current.get(), source, std::move(config), std::move(location));
+	auto previous = this->publish(snapshot);
+	lock.unlock();
+
+	this->notify_subscribers(previous, *snapshot);
+}
+
+bool SettingsManager::load_layer(SettingSource source, const fs::path &file_path)
+{
+	std::error_code error;
+
+	if (file_path.empty() || !fs::is_regular_file(file_path, error))
+	{
+		return false;
+	}
+
+	auto config = std::make_shared<toml::table>();
+
+	if (!this->read_settings_file(file_path, *config, false))
+	{
+		return false;
+	}
+
+	this->replace_layer(source, std::move(config), file_path.string());
+
+	SPD_INFO_CLASS(COMMON::d_settings_group_utils,
+				   fmt::format("Loaded {} settings from: {}", get_setting_source_name(source), file_path.string()));
+
+	return true;
+}
+
+std::shared_ptr<toml::table> SettingsManager::read_environment()
+{
+	auto config = std::make_shared<toml::table>();
+
+#if defined(_WIN32) || defined(WIN32)
+	char **variables = _environ;
+#else
+	char **variables = environ;
+#endif
+
+	for (; variables && *variables; ++variables)
+	{
+		std::string_view variable  = *variables;
+		size_t			 separator = variable.find('=');
+
+		if (separator == std::string_view::npos || !variable.starts_with(ENVIRONMENT_PREFIX))
+		{
+			continue;
+		}
+
+		std::string name(variable.substr(ENVIRONMENT_PREFIX.size(), separator - ENVIRONMENT_PREFIX.size()));
+		std::string path;
+
+		for (size_t i = 0; i < name.size(); ++i)
+		{
+			if (name[i] == '_' && i + 1 < name.size() && name[i + 1] == '_')
+			{
+				path += '.';
+				++i;
+			}
+			else
+			{
+				path += static_cast<char>(std::tolower(static_cast<unsigned char>(name[i])));
+			}
+		}
+
+		if (!assign_value(*config, path, variable.substr(separator + 1)))
+		{
+			SPD_WARN_CLASS(COMMON::d_settings_group_utils,
+						   fmt::format("Ignoring environment variable {}, it does not name a setting.", variable.substr(0, separator)));
+		}
+	}
+
+	return config;
+}
+
+// Text that parses as a TOML value keeps its type, anything else is stored as a string.
+bool SettingsManager::assign_value(toml::table &table, std::string_view path, std::string_view text)
+{
+	if (!DETAIL::is_valid_setting_path(path))
+	{
+		return false;
+	}
+
+	std::vector<std::string_view> keys			= split_path(path);
+	toml::table					 *current_table = &table;
+
+	for (size_t i = 0; i < keys.size() - 1; ++i)
+	{
+		toml::node *next_node = current_table->get(keys[i]);
+
+		if (!next_node)
+		{
+			next_node = &current_table->insert_or_assign(keys[i], toml::table {}).first->second;
+		}
+
+		current_table = next_node->as_table();
+
+		if (!current_table)
+		{
+			return false;
+		}
+	}
+
+	toml::table parsed;
+
+	try
+	{
+		parsed = toml::parse(fmt::format("value = {}", text));
+	}
+	catch (const std::exception &)
+	{
+	}
+
+	if (const toml::node *value = parsed.get("value"))
+	{
+		current_table->insert_or_assign(keys.back(), *value);
+	}
+	else
+	{
+		current_table->insert_or_assign(keys.back(), std::string(text));
+	}
+
+	return true;
+}
+
+bool SettingsManager::set_command_line_overrides(const std::vector<std::string> &assignments)
+{
+	auto config	 = std::make_shared<toml::table>();
+	bool applied = true;
+
+	for (const auto &assignment : assignments)
+	{
+		size_t separator = assignment.find('=');
+
+		if (separator == std::string::npos || !assign_value(*config, assignment.substr(0, separator), assignment.substr(separator + 1)))
+		{
+			SPD_WARN_CLASS(COMMON::d_settings_group_utils, fmt::format("Ignoring setting override '{}', expected path=value.", assignment));
+			applied = false;
+		}
+	}
+
+	this->replace_layer(SettingSource::COMMAND_LINE, std::move(config), "--set");
+
+	return applied;
+}
+
+std::vector<SettingOrigin> SettingsManager::get_setting_origins() const
+{
+	std::vector<SettingOrigin> origins;
+
+	auto snapshot = this->m_snapshot.load(std::memory_order_acquire);
+
+	if (!snapshot)
+	{
+		return origins;
+	}
+
+	origins.reserve(snapshot->settings.size());
+
+	for (const auto &[path, setting] : snapshot->settings)
+	{
+		const Layer &layer = snapshot->layers[std::to_underlying(setting.source)];
+		origins.push_back(SettingOrigin {path, format_value(*setting.node), setting.source, layer.location});
+	}
+
+	std::ranges::sort(origins, {}, &SettingOrigin::path);
+
+	return origins;
+}
+
+// Callers hold m_settings_mutex, so generations are handed out in publication order.
+std::shared_ptr<const SettingsManager::Snapshot> SettingsManager::publish(std::shared_ptr<Snapshot> snapshot)
+{
+	snapshot->generation = this->m_generation.load(std::memory_order_relaxed) + 1;
+
+	uint64_t generation = snapshot->generation;
+	auto	 previous	= this->m_snapshot.exchange(std::move(snapshot), std::memory_order_acq_rel);
+	this->m_generation.store(generation, std::memory_order_release);
+
+	return previous;
+}
+
+void SettingsManager::diff_tables(const toml::table		   &previous,
+								  const toml::table		   &current,
+								  const std::string		   &prefix,
+								  std::vector<std::string> &changed_paths)
+{
+	static const toml::table empty_table;
+
+	auto get_path = [&prefix](std::string_view key) {
+		return prefix.empty() ? std::string(key) : fmt::format("{}.{}", prefix, key);
+	};
+
+	for (auto &&[key, node] : previous)
+	{
+		const toml::node *other = current.get(key.str());
+
+		if (node.is_table() || (other && other->is_table()))
+		{
+			const toml::table &previous_table = node.is_table() ? *node.as_table() : empty_table;
+			const toml::table &current_table  = other && other->is_table() ? *other->as_table() : empty_table;
+
+			// A value replaced by a table or the other way round changes the path itself as well.
+			if (other && node.is_table() != other->is_table())
+			{
+				changed_paths.push_back(get_path(key.str()));
+			}
+
+			diff_tables(previous_table, current_table, get_path(key.str()), changed_paths);
+		}
+		else if (!other || !nodes_equal(node, *other))
+		{
+			changed_paths.push_back(get_path(key.str()));
+		}
+	}
+
+	for (auto &&[key, node] : current)
+	{
+		if (previous.get(key.str()))
+		{
+			continue;
+		}
+
+		if (node.is_table())
+		{
+			diff_tables(empty_table, *node.as_table(), get_path(key.str()), changed_paths);
+		}
+		else
+		{
+			changed_paths.push_back(get_path(key.str()));
+		}
+	}
+}
+
+void SettingsManager::notify_subscribers(const std::shared_ptr<const Snapshot> &previous, const Snapshot &current)
+{
+	static const toml::table empty_table;
+
+	// Callbacks run after the lock is released, so they may change settings and subscribe themselves.
+	std::vector<std::pair<std::shared_ptr<Subscription>, std::vector<std::string>>> notifications;
+	{
+		std::lock_guard<std::mutex> lock(this->m_subscriptions_mutex);
+
+		if (this->m_subscriptions.empty())
+		{
+			return;
+		}
+	}
+
+	std::vector<std::string> changed_paths;
+	diff_tables(previous ? previous->config : empty_table, current.config, "", changed_paths);
+
+	if (changed_paths.empty())
+	{
+		return;
+	}
+
+	SPD_DEBUG_CLASS(COMMON::d_settings_group_utils, fmt::format("Settings changed at {} paths.", changed_paths.size()));
+
+	{
+		std::lock_guard<std::mutex> lock(this->m_subscriptions_mutex);
+
+		for (const auto &[id, subscription] : this->m_subscriptions)
+		{
+			const std::string		&prefix = subscription->prefix;
+			std::vector<std::string> matched_paths;
+
+			for (const auto &path : changed_paths)
+			{
+				if (prefix.empty() || path == prefix || (path.starts_with(prefix) && path[prefix.size()] == '.'))
+				{
+					matched_paths.push_back(path);
+				}
+			}
+
+			if (!matched_paths.empty())
+			{
+				subscription->running.fetch_add(1, std::memory_order_relaxed);
+				notifications.emplace_back(subscription, std::move(matched_paths));
+			}
+		}
+	}
+
+	for (const auto &[subscription, matched_paths] : notifications)
+	{
+		const void *outer		 = t_notifying_subscription;
+		t_notifying_subscription  = subscription.get();
+
+		subscription->callback(matched_paths);
+
+		t_notifying_subscription = outer;
+		subscription->running.fetch_sub(1, std::memory_order_release);
+		subscription->running.notify_all();
+	}
+}
+
+uint64_t SettingsManager::subscribe(std::string prefix, SettingsCallback callback)
+{
+	auto subscription	   = std::make_shared<Subscription>();
+	subscription->prefix   = std::move(prefix);
+	subscription->callback = std::move(callback);
+
+	std::lock_guard<std::mutex> lock(this->m_subscriptions_mutex);
+
+	uint64_t id = this->m_next_subscription_id++;
+	this->m_subscriptions.emplace(id, std::move(subscription));
+
+	return id;
+}
+
+// Waits for callbacks that are already running, so the subscriber can be destroyed afterwards. The wait
+// happens outside the lock so that those callbacks can still reach the settings manager.
+void SettingsManager::unsubscribe(uint64_t id)
+{
+	std::shared_ptr<Subscription> subscription;
+	{
+		std::lock_guard<std::mutex> lock(this->m_subscriptions_mutex);
+
+		auto entry = this->m_subscriptions.find(id);
+		if (entry == this->m_subscriptions.end())
+		{
+			return;
+		}
+
+		subscription = std::move(entry->second);
+		this->m_subscriptions.erase(entry);
+	}
+
+	// A callback that unsubscribes itself would otherwise wait for its own return.
+	uint32_t own	 = t_notifying_subscription == subscription.get() ? 1 : 0;
+	uint32_t running = subscription->running.load(std::memory_order_acquire);
+
+	while (running > own)
+	{
+		subscription->running.wait(running, std::memory_order_acquire);
+		running = subscription->running.load(std::memory_order_acquire);
+	}
+}
+
 bool SettingsManager::load_settings()
 {
 	SPD_DEBUG_CLASS(COMMON::d_settings_group_utils, "Loading settings.");
@@ -161,16 +873,80 @@ bool SettingsManager::load_settings()
 
 bool SettingsManager::load_settings(fs::path file_path)
 {
-	std::lock_guard<std::mutex> lock(m_settings_mutex);
-
 	if (!fs::exists(file_path) || fs::is_directory(file_path) || file_path.empty())
 	{
 		return false;
 	}
 
+	auto config = std::make_shared<toml::table>();
+
+	if (!this->read_settings_file(file_path, *config, true))
+	{
+		return false;
+	}
+
+	std::unique_lock<std::mutex> lock(m_settings_mutex);
+
+	// Our own saves come back through the file watcher. Publishing them would undo settings changed since.
+	if (file_path == this->m_config_path && this->m_saved_config && *this->m_saved_config == *config)
+	{
+		return true;
+	}
+
+	this->m_config_path = file_path;
+
+	auto current = this->m_snapshot.load(std::memory_order_acquire);
+	if (current)
+	{
+		const auto &user_config = current->layers[std::to_underlying(SettingSource::USER)].config;
+
+		if (user_config && *user_config == *config)
+		{
+			this->m_saved_config = user_config;
+			return true;
+		}
+	}
+
+	auto snapshot		 = this->build_snapshot(current.get(), SettingSource::USER, config, file_path.string());
+	auto previous		 = this->publish(snapshot);
+	this->m_saved_config = std::move(config);
+	lock.unlock();
+
+	this->notify_subscribers(previous, *snapshot);
+
+	return true;
+}
+
+// Caches are only written for the user settings, the other layers live in directories the application
+// does not own, such as /etc or whatever directory it is started in.
+bool SettingsManager::read_settings_file(const fs::path &file_path, toml::table &config, bool update_cache) const
+{
+	MappedFile source;
+
+	if (!source.open(file_path))
+	{
+		SPD_ERROR_CLASS(COMMON::d_settings_group_utils, fmt::format("Failed to open settings file at {}", file_path.string()));
+		return false;
+	}
+
+	std::error_code error;
+	auto			source_time = fs::last_write_time(file_path, error);
+	bool			use_cache	= !error && this->get_setting<bool>("settings.binary_cache", true);
+
+	if (use_cache)
+	{
+		MappedFile cache;
+
+		if (cache.open(get_settings_cache_path(file_path)) && decode_settings_cache(cache.data(), source.data(), source_time, config))
+		{
+			SPD_DEBUG_CLASS(COMMON::d_settings_group_utils, fmt::format("Settings read from cache of {}", file_path.string()));
+			return true;
+		}
+	}
+
 	try
 	{
-		this->m_config = std::make_unique<toml::table>(toml::parse_file(file_path.string()));
+		config = toml::parse(std::string_view(reinterpret_cast<const char *>(source.data().data()), source.size()), file_path.string());
 	}
 	catch (const std::exception &error)
 	{
@@ -178,25 +954,215 @@ bool SettingsManager::load_settings(fs::path file_path)
 		return false;
 	}
 
-	this->m_config_path = file_path;
+	if (use_cache && update_cache)
+	{
+		this->update_settings_cache(file_path, config, source.data());
+	}
 
 	return true;
 }
 
-bool SettingsManager::save_settings()
+void SettingsManager::update_settings_cache(const fs::path &file_path, const toml::table &config, std::span<const std::byte> source) const
 {
-	SPD_DEBUG_CLASS(COMMON::d_settings_group_utils, "Saving settings.");
+	std::error_code error;
+	auto			source_time = fs::last_write_time(file_path, error);
+	std::string		encoded;
+
+	if (error || !encode_settings_cache(config, source, source_time, encoded))
+	{
+		SPD_DEBUG_CLASS(COMMON::d_settings_group_utils, fmt::format("Settings in {} cannot be cached.", file_path.string()));
+		return;
+	}
+
+	// The cache is a readable copy of every setting, so it must not be more accessible than its source.
+	// Without it the file is parsed again on the next start, which is not worth more than a debug message.
+	if (!write_file_atomically(get_settings_cache_path(file_path), encoded, error, file_path))
+	{
+		SPD_DEBUG_CLASS(COMMON::d_settings_group_utils,
+						fmt::format("Unable to write settings cache for {}: {}", file_path.string(), error.message()));
+	}
+}
+
+bool SettingsManager::reload_settings()
+{
+	fs::path config_path;
+	{
+		std::lock_guard<std::mutex> lock(m_settings_mutex);
+		config_path = this->m_config_path;
+	}
+
+	if (config_path.empty() || !this->load_settings(config_path))
+	{
+		SPD_WARN_CLASS(COMMON::d_settings_group_utils, "Unable to reload settings, keeping the current configuration.");
+		return false;
+	}
+
+	SPD_DEBUG_CLASS(COMMON::d_settings_group_utils, fmt::format("Settings reloaded from: {}", config_path.string()));
+
+	return true;
+}
 
-	if (!this->m_config)
+bool SettingsManager::save_settings()
+{
+	if (!this->m_snapshot.load(std::memory_order_acquire))
 	{
 		this->create_default_settings();
 	}
 
-	if (!this->m_config_path.empty() && !fs::is_directory(this->m_config_path))
 	{
-		if (this->save_settings(this->m_config_path))
+		std::lock_guard<std::mutex> lock(this->m_writer_mutex);
+
+		if (this->m_writer_running)
+		{
+			this->m_save_requested = true;
+			this->m_writer_condition.notify_one();
+			return true;
+		}
+	}
+
+	return this->write_settings();
+}
+
+bool SettingsManager::save_settings(fs::path file_path)
+{
+	if (fs::is_directory(file_path) || file_path.empty())
+	{
+		return false;
+	}
+
+	if (!this->m_snapshot.load(std::memory_order_acquire))
+	{
+		if (!restore_defaults())
+		{
+			SPD_ERROR_CLASS(COMMON::d_settings_group_utils, "Cannot save settings without a default configuration.");
+			return false;
+		}
+	}
+
+	static const toml::table empty_table;
+
+	std::lock_guard<std::mutex> lock(this->m_save_mutex);
+
+	auto	   snapshot	   = this->m_snapshot.load(std::memory_order_acquire);
+	const auto &user_config = snapshot->layers[std::to_underlying(SettingSource::USER)].config;
+
+	return this->write_config(user_config ? *user_config : empty_table, file_path);
+}
+
+bool SettingsManager::flush_settings()
+{
+	{
+		std::lock_guard<std::mutex> lock(this->m_writer_mutex);
+
+		if (!this->m_save_requested)
+		{
+			return true;
+		}
+
+		this->m_save_requested = false;
+	}
+
+	return this->write_settings();
+}
+
+void SettingsManager::start_writer()
+{
+	std::lock_guard<std::mutex> lock(this->m_writer_mutex);
+
+	if (this->m_writer_running)
+	{
+		return;
+	}
+
+	this->m_writer_running = true;
+	this->m_writer_thread  = std::thread(&SettingsManager::run_writer, this);
+}
+
+// A save that is still pending is written before the writer exits.
+void SettingsManager::stop_writer()
+{
+	{
+		std::lock_guard<std::mutex> lock(this->m_writer_mutex);
+		this->m_writer_running = false;
+	}
+
+	this->m_writer_condition.notify_all();
+
+	if (this->m_writer_thread.joinable())
+	{
+		this->m_writer_thread.join();
+	}
+}
+
+void SettingsManager::run_writer()
+{
+	auto delay = std::chrono::milliseconds(std::max<int64_t>(this->get_setting<int64_t>("settings.save_delay_ms", 100), 0));
+
+	std::unique_lock<std::mutex> lock(this->m_writer_mutex);
+
+	for (;;)
+	{
+		this->m_writer_condition.wait(lock, [this] { return this->m_save_requested || !this->m_writer_running; });
+
+		if (!this->m_save_requested)
+		{
+			return;
+		}
+
+		// Saves requested while waiting are merged into this one.
+		this->m_writer_condition.wait_for(lock, delay, [this] { return !this->m_writer_running; });
+
+		if (!this->m_save_requested)
+		{
+			continue;
+		}
+
+		this->m_save_requested = false;
+
+		lock.unlock();
+		this->write_settings();
+		lock.lock();
+	}
+}
+
+bool SettingsManager::write_settings()
+{
+	// Serializes writers, readers and set_setting keep working on the published snapshots meanwhile.
+	std::lock_guard<std::mutex> save_lock(this->m_save_mutex);
+
+	auto							   snapshot = this->m_snapshot.load(std::memory_order_acquire);
+	fs::path						   config_path;
+	std::shared_ptr<const toml::table> saved_config;
+	{
+		std::lock_guard<std::mutex> lock(this->m_settings_mutex);
+		config_path	 = this->m_config_path;
+		saved_config = this->m_saved_config;
+	}
+
+	// Only the user layer is written, the other sources are never saved.
+	auto user_config = snapshot ? snapshot->layers[std::to_underlying(SettingSource::USER)].config : nullptr;
+
+	if (!user_config)
+	{
+		return false;
+	}
+
+	if (!config_path.empty() && user_config == saved_config)
+	{
+		SPD_DEBUG_CLASS(COMMON::d_settings_group_utils, "Settings are unchanged, skipping save.");
+		return true;
+	}
+
+	SPD_DEBUG_CLASS(COMMON::d_settings_group_utils, "Saving settings.");
+
+	if (!config_path.empty() && !fs::is_directory(config_path))
+	{
+		if (this->write_config(*user_config, config_path))
 		{
-			SPD_INFO_CLASS(COMMON::d_settings_group_utils, fmt::format("Settings successfully saved: {}", this->m_config_path.string()));
+			std::lock_guard<std::mutex> lock(this->m_settings_mutex);
+			this->m_saved_config = user_config;
+
+			SPD_INFO_CLASS(COMMON::d_settings_group_utils, fmt::format("Settings successfully saved: {}", config_path.string()));
 			return true;
 		}
 	}
@@ -211,10 +1177,13 @@ bool SettingsManager::save_settings()
 
 		auto config_file = path / COMMON::d_project_name / DEFAULT_CONFIG_FILE_NAME;
 
-		if (this->save_settings(config_file))
+		if (this->write_config(*user_config, config_file))
 		{
-			this->m_config_path = path / COMMON::d_project_name / DEFAULT_CONFIG_FILE_NAME;
-			SPD_INFO_CLASS(COMMON::d_settings_group_utils, fmt::format("Settings successfully saved: {}", this->m_config_path.string()));
+			std::lock_guard<std::mutex> lock(this->m_settings_mutex);
+			this->m_config_path	 = config_file;
+			this->m_saved_config = user_config;
+
+			SPD_INFO_CLASS(COMMON::d_settings_group_utils, fmt::format("Settings successfully saved: {}", config_file.string()));
 			return true;
 		}
 	}
@@ -224,27 +1193,34 @@ bool SettingsManager::save_settings()
 	return false;
 }
 
-bool SettingsManager::save_settings(fs::path file_path)
+// Callers hold m_save_mutex.
+bool SettingsManager::write_config(const toml::table &config, const fs::path &file_path)
 {
-	std::lock_guard<std::mutex> lock(m_settings_mutex);
+	std::ostringstream stream;
 
-	if (fs::is_directory(file_path) || file_path.empty())
+	if (config.empty() && this->m_config_default)
 	{
-		return false;
-	}
+		// Lists the defaults for reference without overriding them.
+		std::ostringstream default_stream;
+		default_stream << *this->m_config_default;
+		std::istringstream defaults(default_stream.str());
 
-	if (!this->m_config)
-	{
-		if (!restore_defaults())
+		stream << "# Uncomment a setting to override the system settings and the built-in defaults.\n";
+		for (std::string line; std::getline(defaults, line);)
 		{
-			SPD_ERROR_CLASS(COMMON::d_settings_group_utils, "Cannot save settings without a default configuration.");
-			return false;
+			stream << (line.empty() ? "#" : "# " + line) << '\n';
 		}
 	}
+	else
+	{
+		stream << config;
+	}
+
+	std::string contents = stream.str();
 
 	try
 	{
-		if (!fs::exists(file_path.parent_path()))
+		if (file_path.has_parent_path() && !fs::exists(file_path.parent_path()))
 		{
 			if (!fs::create_directories(file_path.parent_path()))
 			{
@@ -254,17 +1230,13 @@ bool SettingsManager::save_settings(fs::path file_path)
 			}
 		}
 
-		std::ofstream file(file_path, std::ios::out | std::ios::trunc);
+		std::error_code error;
 
-		if (!file.is_open())
+		if (!write_file_atomically(file_path, contents, error))
 		{
-			SPD_ERROR_CLASS(COMMON::d_settings_group_utils, fmt::format("Failed to create config file: {}", file_path.string()));
+			SPD_ERROR_CLASS(COMMON::d_settings_group_utils, fmt::format("Failed to write config file {}: {}", file_path.string(), error.message()));
 			return false;
 		}
-
-		file << *this->m_config.get();
-
-		file.close();
 	}
 	catch (const fs::filesystem_error &e)
 	{
@@ -273,48 +1245,71 @@ bool SettingsManager::save_settings(fs::path file_path)
 		return false;
 	}
 
+	if (this->get_setting<bool>("settings.binary_cache", true))
+	{
+		this->update_settings_cache(file_path, config, std::as_bytes(std::span(contents)));
+	}
+
 	return true;
 }
 
 bool SettingsManager::restore_defaults()
 {
-	std::lock_guard<std::mutex> lock(m_settings_mutex);
+	std::unique_lock<std::mutex> lock(m_settings_mutex);
 
 	if (!this->m_config_default)
 	{
 		return false;
 	}
 
-	this->m_config = std::make_unique<toml::table>(*this->m_config_default.get());
+	// An empty user layer lets every setting fall through to the system settings and the built-in defaults.
+	auto current  = this->m_snapshot.load(std::memory_order_acquire);
+	auto config	  = std::make_shared<toml::table>();
+	auto snapshot = this->build_snapshot(current.get(), SettingSource::USER, std::move(config), this->m_config_path.string());
+	auto previous = this->publish(snapshot);
+	lock.unlock();
+
+	this->notify_subscribers(previous, *snapshot);
 
 	return true;
 }
 
 std::string SettingsManager::dump() const
 {
-	if (!m_config)
+	auto snapshot = this->m_snapshot.load(std::memory_order_acquire);
+
+	if (!snapshot)
 	{
 		return "# No configuration is currently loaded.\n";
 	}
 
 	std::ostringstream ss;
-	ss << (*m_config);
+	ss << snapshot->config;
 	return ss.str();
 }
 
 void SettingsManager::dump(std::ostream &output) const
 {
-	if (!m_config)
+	auto snapshot = this->m_snapshot.load(std::memory_order_acquire);
+
+	if (!snapshot)
 	{
 		output << "# No configuration is currently loaded.\n";
 		return;
 	}
 
-	output << (*m_config);
+	output << snapshot->config;
 }
 
 SettingsManager::~SettingsManager()
 {
-	return;
+	this->shutdown();
+}
+
+// The writer finishes a pending save before it exits, later saves are written synchronously.
+void SettingsManager::shutdown()
+{
+	this->m_config_watcher.stop();
+	this->stop_writer();
 }
 } // namespace UTILS
@@ -1,19 +1,55 @@
 #ifndef SETTINGS_MANAGER_HPP
 #define SETTINGS_MANAGER_HPP
 
+#include "file_watcher.hpp"
 #include "manager_singleton.hpp"
+#include "setting_key.hpp"
 
+#include <array>
+#include <atomic>
+#include <condition_variable>
 #include <cstdlib>
 #include <filesystem>
+#include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <ostream>
+#include <span>
 #include <string>
+#include <thread>
 #include <toml++/toml.hpp>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace fs = std::filesystem;
 
 namespace UTILS
 {
+// Sources in the order they are merged, later sources override earlier ones.
+enum class SettingSource
+{
+	DEFAULTS,
+	SYSTEM,
+	USER,
+	PROJECT,
+	ENVIRONMENT,
+	COMMAND_LINE
+};
+
+struct SettingOrigin
+{
+	std::string	  path;
+	std::string	  value;
+	SettingSource source = SettingSource::DEFAULTS;
+	std::string	  location; // File, environment prefix or command line flag
+};
+
+std::string_view get_setting_source_name(SettingSource source);
+
 class SettingsManager : public UTILS::ManagerSingleton<SettingsManager>
 {
 	friend class ManagerSingleton<SettingsManager>;
@@ -28,19 +64,48 @@ private:
 	static std::vector<std::string_view> split_path(std::string_view path);
 
 public:
+	using SettingsCallback = std::function<void(const std::vector<std::string>& changed_paths)>;
+
 	std::string_view get_manager_name() const override;
 
 	~SettingsManager();
+	void shutdown() override;
 
 	bool load_settings();
 	bool load_settings(fs::path file_path);
+	bool restore_defaults();
+
+	// Hands the save to a background writer once the settings are initialized, so calls made in quick
+	// succession end up as a single write. Nothing is written when the file already holds the current settings.
 	bool save_settings();
 	bool save_settings(fs::path file_path);
-	bool restore_defaults();
+
+	// Writes a pending save right away instead of waiting for the background writer.
+	bool flush_settings();
+
+	// Applies "path=value" assignments on top of every other source. They last for this run and are never saved.
+	bool set_command_line_overrides(const std::vector<std::string>& assignments);
+
+	// Every effective setting together with the source it came from, sorted by path.
+	std::vector<SettingOrigin> get_setting_origins() const;
+
+	// Parses the settings file again and publishes it if anything changed. Runs automatically when
+	// the file is edited and settings.hot_reload is enabled.
+	bool reload_settings();
+
+	// The callback receives the changed paths at or below the prefix, an empty prefix receives every
+	// change. Callbacks run on the thread that changed the settings, without any lock held. Unsubscribe
+	// waits for callbacks still running on other threads, so the subscriber can be destroyed afterwards.
+	uint64_t subscribe(std::string prefix, SettingsCallback callback);
+	void	 unsubscribe(uint64_t id);
 
 	template<typename T>
 	T get_setting(std::string_view path, T default_value) const;
 
+	// Resolved values are cached per thread until the configuration changes.
+	template<typename T, SettingPath Path>
+	T get_setting(SettingKey<T, Path> key, std::type_identity_t<T> default_value) const;
+
 	template<typename T>
 	bool set_setting(std::string_view path, T value);
 
@@ -48,48 +113,168 @@ public:
 	void		dump(std::ostream& output) const;
 
 private:
-	fs::path					 m_config_path;
-	std::unique_ptr<toml::table> m_config;
-	std::unique_ptr<toml::table> m_config_default;
+	static constexpr size_t SOURCE_COUNT = std::to_underlying(SettingSource::COMMAND_LINE) + 1;
+
+	struct Layer
+	{
+		std::shared_ptr<const toml::table> config;
+		std::string						   location;
+	};
+
+	struct ResolvedSetting
+	{
+		const toml::node* node	 = nullptr;
+		SettingSource	  source = SettingSource::DEFAULTS;
+	};
+
+	struct PathHash
+	{
+		using is_transparent = void;
+
+		size_t operator()(std::string_view path) const
+		{
+			return DETAIL::hash_setting_path(path);
+		}
+
+		size_t operator()(const DETAIL::HashedSettingPath& hashed) const
+		{
+			return hashed.hash;
+		}
+	};
+
+	// Published configurations are never modified. Writers replace one layer, merge the layers again and
+	// publish the result, so readers work on whichever snapshot they loaded without taking a lock.
+	// Values are indexed by their full path, a lookup is a single hash probe.
+	struct Snapshot
+	{
+		std::array<Layer, SOURCE_COUNT>												layers;
+		toml::table																	config;
+		std::unordered_map<std::string, ResolvedSetting, PathHash, std::equal_to<>> settings; // Points into config
+		uint64_t																	generation = 0;
+
+		Snapshot()							 = default;
+		Snapshot(const Snapshot&)			 = delete;
+		Snapshot& operator=(const Snapshot&) = delete;
+	};
+
+	struct Subscription
+	{
+		std::string			  prefix;
+		SettingsCallback	  callback;
+		std::atomic<uint32_t> running = 0; // Callbacks in progress, unsubscribe waits for them
+	};
+
+	static std::shared_ptr<Snapshot> build_snapshot(const Snapshot*					   current,
+													SettingSource					   source,
+													std::shared_ptr<const toml::table> config,
+													std::string						   location);
+
+	std::shared_ptr<const Snapshot> publish(std::shared_ptr<Snapshot> snapshot);
+	void							replace_layer(SettingSource source, std::shared_ptr<const toml::table> config, std::string location);
+	bool							load_layer(SettingSource source, const fs::path& file_path);
+
+	static std::shared_ptr<toml::table> read_environment();
+	static bool							assign_value(toml::table& table, std::string_view path, std::string_view text);
+	void							notify_subscribers(const std::shared_ptr<const Snapshot>& previous, const Snapshot& current);
+	void							start_watching();
+
+	void start_writer();
+	void stop_writer();
+	void run_writer();
+	bool write_settings();
+	bool write_config(const toml::table& config, const fs::path& file_path);
+
+	bool read_settings_file(const fs::path& file_path, toml::table& config, bool update_cache) const;
+	void update_settings_cache(const fs::path& file_path, const toml::table& config, std::span<const std::byte> source) const;
+
+	static void diff_tables(const toml::table&		  previous,
+							const toml::table&		  current,
+							const std::string&		  prefix,
+							std::vector<std::string>& changed_paths);
+
+private:
+	fs::path									 m_config_path;
+	std::atomic<std::shared_ptr<const Snapshot>> m_snapshot;
+	std::atomic<uint64_t>						 m_generation = 0;
+	std::shared_ptr<const toml::table>			 m_config_default;
+	std::shared_ptr<const toml::table>			 m_saved_config; // What the settings file holds
+
+	FileWatcher										  m_config_watcher;
+	std::map<uint64_t, std::shared_ptr<Subscription>> m_subscriptions;
+	uint64_t										  m_next_subscription_id = 1;
+
+	std::thread				m_writer_thread;
+	std::condition_variable m_writer_condition;
+	bool					m_writer_running = false;
+	bool					m_save_requested = false;
 
 protected:
 	mutable std::mutex m_settings_mutex;
+	std::mutex		   m_subscriptions_mutex;
+	std::mutex		   m_writer_mutex;
+	std::mutex		   m_save_mutex;
 };
 
 template<typename T>
 T SettingsManager::get_setting(std::string_view path, T default_value) const
 {
-	std::lock_guard<std::mutex> lock(m_settings_mutex);
+	auto snapshot = this->m_snapshot.load(std::memory_order_acquire);
 
-	if (!this->m_config)
+	if (!snapshot)
 	{
 		return default_value;
 	}
 
-	const toml::node* current_node = this->m_config.get();
-	for (const auto& key : this->split_path(path))
+	auto setting = snapshot->settings.find(path);
+
+	if (setting == snapshot->settings.end())
 	{
-		if (!current_node || !current_node->is_table())
-		{
-			return default_value;
-		}
-		current_node = current_node->as_table()->get(key);
+		return default_value;
 	}
 
-	if (!current_node)
+	return setting->second.node->value_or(default_value);
+}
+
+template<typename T, SettingPath Path>
+T SettingsManager::get_setting(SettingKey<T, Path>, std::type_identity_t<T> default_value) const
+{
+	struct CachedValue
 	{
-		return default_value;
+		uint64_t		 generation = 0;
+		std::optional<T> value;
+	};
+
+	thread_local CachedValue cached;
+
+	if (cached.generation != this->m_generation.load(std::memory_order_acquire))
+	{
+		auto snapshot = this->m_snapshot.load(std::memory_order_acquire);
+
+		cached.generation = snapshot ? snapshot->generation : 0;
+		cached.value	  = std::nullopt;
+
+		if (snapshot)
+		{
+			auto setting = snapshot->settings.find(SettingKey<T, Path>::hashed_path);
+
+			if (setting != snapshot->settings.end())
+			{
+				cached.value = setting->second.node->template value<T>();
+			}
+		}
 	}
 
-	return current_node->value_or(default_value);
+	return cached.value ? *cached.value : default_value;
 }
 
 template<typename T>
 bool SettingsManager::set_setting(std::string_view path, T value)
 {
-	std::lock_guard<std::mutex> lock(m_settings_mutex);
+	std::unique_lock<std::mutex> lock(m_settings_mutex);
 
-	if (!this->m_config)
+	auto current = this->m_snapshot.load(std::memory_order_acquire);
+
+	if (!current)
 	{
 		SPD_ERROR_CLASS(COMMON::d_settings_group_utils, "Settings are not loaded, cannot perform set_settings.");
 		return false;
@@ -103,7 +288,9 @@ bool SettingsManager::set_setting(std::string_view path, T value)
 		return false;
 	}
 
-	toml::table* current_table = this->m_config.get();
+	const Layer& user_layer	   = current->layers[std::to_underlying(SettingSource::USER)];
+	auto		 config		   = user_layer.config ? std::make_shared<toml::table>(*user_layer.config) : std::make_shared<toml::table>();
+	toml::table* current_table = config.get();
 
 	for (size_t i = 0; i < keys.size() - 1; ++i)
 	{
@@ -131,6 +318,12 @@ bool SettingsManager::set_setting(std::string_view path, T value)
 
 	current_table->insert_or_assign(keys.back(), value);
 
+	auto snapshot = this->build_snapshot(current.get(), SettingSource::USER, std::move(config), user_layer.location);
+	auto previous = this->publish(snapshot);
+	lock.unlock();
+
+	this->notify_subscribers(previous, *snapshot);
+
 	return true;
 }
 
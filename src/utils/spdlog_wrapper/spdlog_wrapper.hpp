@@ -19,7 +19,13 @@
 #define FMT_COLOR_RESET	 "\033[0m"
 
 #define SPD_LOG_CLASS(level, class_name, message)                                                                                                  \
-	spdlog::log(level, fmt::format("[{}{}{}] {}", FMT_COLOR_CYAN, class_name, FMT_COLOR_RESET, message))
+	do                                                                                                                                             \
+	{                                                                                                                                              \
+		if (spdlog::should_log(level))                                                                                                             \
+		{                                                                                                                                          \
+			spdlog::log(level, fmt::format("[{}{}{}] {}", FMT_COLOR_CYAN, class_name, FMT_COLOR_RESET, message));                                  \
+		}                                                                                                                                          \
+	} while (false)
 
 #define SPD_DEBUG_CLASS(class_name, message) SPD_LOG_CLASS(spdlog::level::debug, class_name, message)
 
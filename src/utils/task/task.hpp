@@ -0,0 +1,254 @@
+#ifndef TASK_HPP
+#define TASK_HPP
+
+#include <coroutine>
+#include <exception>
+#include <future>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace UTILS
+{
+template<typename T>
+class Task;
+
+namespace DETAIL
+{
+template<typename T>
+struct TaskPromiseBase
+{
+	std::coroutine_handle<> continuation;
+	std::exception_ptr		exception;
+
+	struct FinalAwaiter
+	{
+		bool await_ready() const noexcept
+		{
+			return false;
+		}
+
+		template<typename Promise>
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> coroutine) noexcept
+		{
+			auto continuation = coroutine.promise().continuation;
+			return continuation ? continuation : std::noop_coroutine();
+		}
+
+		void await_resume() const noexcept
+		{}
+	};
+
+	std::suspend_always initial_suspend() const noexcept
+	{
+		return {};
+	}
+
+	FinalAwaiter final_suspend() const noexcept
+	{
+		return {};
+	}
+
+	void unhandled_exception() noexcept
+	{
+		this->exception = std::current_exception();
+	}
+};
+
+template<typename T>
+struct TaskPromise : TaskPromiseBase<T>
+{
+	std::optional<T> value;
+
+	Task<T> get_return_object() noexcept;
+
+	template<typename U>
+	void return_value(U&& result)
+	{
+		this->value.emplace(std::forward<U>(result));
+	}
+
+	T take_result()
+	{
+		if (this->exception)
+		{
+			std::rethrow_exception(this->exception);
+		}
+		return std::move(*this->value);
+	}
+};
+
+template<>
+struct TaskPromise<void> : TaskPromiseBase<void>
+{
+	Task<void> get_return_object() noexcept;
+
+	void return_void() const noexcept
+	{}
+
+	void take_result()
+	{
+		if (this->exception)
+		{
+			std::rethrow_exception(this->exception);
+		}
+	}
+};
+
+struct DetachedTask
+{
+	struct promise_type
+	{
+		DetachedTask get_return_object() const noexcept
+		{
+			return {};
+		}
+
+		std::suspend_never initial_suspend() const noexcept
+		{
+			return {};
+		}
+
+		std::suspend_never final_suspend() const noexcept
+		{
+			return {};
+		}
+
+		void return_void() const noexcept
+		{}
+
+		void unhandled_exception() const noexcept
+		{
+			std::terminate();
+		}
+	};
+};
+} // namespace DETAIL
+
+// Lazily started coroutine. The body runs when the task is awaited and resumes the awaiting
+// coroutine on whichever thread the task finishes on.
+template<typename T = void>
+class [[nodiscard]] Task
+{
+public:
+	using promise_type = DETAIL::TaskPromise<T>;
+
+	Task() = default;
+
+	explicit Task(std::coroutine_handle<promise_type> coroutine) :
+		m_coroutine(coroutine)
+	{}
+
+	Task(Task&& other) noexcept :
+		m_coroutine(std::exchange(other.m_coroutine, {}))
+	{}
+
+	Task& operator=(Task&& other) noexcept
+	{
+		if (this != &other)
+		{
+			this->destroy();
+			this->m_coroutine = std::exchange(other.m_coroutine, {});
+		}
+		return *this;
+	}
+
+	Task(const Task&)			 = delete;
+	Task& operator=(const Task&) = delete;
+
+	~Task()
+	{
+		this->destroy();
+	}
+
+	auto operator co_await() && noexcept
+	{
+		struct Awaiter
+		{
+			std::coroutine_handle<promise_type> coroutine;
+
+			bool await_ready() const noexcept
+			{
+				return !this->coroutine || this->coroutine.done();
+			}
+
+			std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+			{
+				this->coroutine.promise().continuation = awaiting;
+				return this->coroutine;
+			}
+
+			T await_resume()
+			{
+				return this->coroutine.promise().take_result();
+			}
+		};
+
+		return Awaiter {this->m_coroutine};
+	}
+
+private:
+	void destroy()
+	{
+		if (this->m_coroutine)
+		{
+			this->m_coroutine.destroy();
+			this->m_coroutine = {};
+		}
+	}
+
+private:
+	std::coroutine_handle<promise_type> m_coroutine;
+};
+
+template<typename T>
+Task<T> DETAIL::TaskPromise<T>::get_return_object() noexcept
+{
+	return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline Task<void> DETAIL::TaskPromise<void>::get_return_object() noexcept
+{
+	return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+// Starts the task on the calling thread without waiting for it. Exceptions escaping the task terminate.
+template<typename T>
+void spawn(Task<T> task)
+{
+	[](Task<T> detached) -> DETAIL::DetachedTask {
+		co_await std::move(detached);
+	}(std::move(task));
+}
+
+// Blocks the calling thread until the task finishes. Must not be called from the thread the task resumes on.
+template<typename T>
+T sync_wait(Task<T> task)
+{
+	std::promise<T> promise;
+	auto			future = promise.get_future();
+
+	[](Task<T> awaited, std::promise<T> result) -> DETAIL::DetachedTask {
+		try
+		{
+			if constexpr (std::is_void_v<T>)
+			{
+				co_await std::move(awaited);
+				result.set_value();
+			}
+			else
+			{
+				result.set_value(co_await std::move(awaited));
+			}
+		}
+		catch (...)
+		{
+			result.set_exception(std::current_exception());
+		}
+	}(std::move(task), std::move(promise));
+
+	return future.get();
+}
+} // namespace UTILS
+
+#endif // TASK_HPP
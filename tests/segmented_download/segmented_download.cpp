@@ -0,0 +1,258 @@
+#include "network_manager.hpp"
+
+#include <atomic>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+// Exercises NetworkManager::download_file_segmented against a server on the loopback interface that
+// supports HEAD, byte ranges and an ETag, and can cut its responses short to simulate a dropped transfer.
+
+namespace
+{
+class LoopbackServer
+{
+public:
+	LoopbackServer(std::string payload, std::string etag) : m_payload(std::move(payload)), m_etag(std::move(etag))
+	{
+		this->m_listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+
+		int enable = 1;
+		setsockopt(this->m_listen_fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+		sockaddr_in address {};
+		address.sin_family		= AF_INET;
+		address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		address.sin_port		= 0;
+
+		socklen_t length = sizeof(address);
+		bind(this->m_listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+		listen(this->m_listen_fd, 64);
+		getsockname(this->m_listen_fd, reinterpret_cast<sockaddr*>(&address), &length);
+
+		this->m_port   = ntohs(address.sin_port);
+		this->m_thread = std::thread(&LoopbackServer::run, this);
+	}
+
+	~LoopbackServer()
+	{
+		this->m_running = false;
+		shutdown(this->m_listen_fd, SHUT_RDWR);
+		close(this->m_listen_fd);
+		this->m_thread.join();
+
+		for (auto& connection : this->m_connections)
+		{
+			connection.join();
+		}
+	}
+
+	std::string get_url() const
+	{
+		return fmt::format("http://127.0.0.1:{}/payload.bin", this->m_port);
+	}
+
+	void set_etag(std::string etag)
+	{
+		std::lock_guard<std::mutex> lock(this->m_mutex);
+		this->m_etag = std::move(etag);
+	}
+
+	// Ranged responses send half of their body and then drop the connection.
+	void set_truncate(bool truncate)
+	{
+		this->m_truncate = truncate;
+	}
+
+	uint64_t take_bytes_served()
+	{
+		return this->m_bytes_served.exchange(0);
+	}
+
+private:
+	void run()
+	{
+		while (this->m_running)
+		{
+			int connection = accept(this->m_listen_fd, nullptr, nullptr);
+
+			if (connection < 0)
+			{
+				continue;
+			}
+
+			this->m_connections.emplace_back(&LoopbackServer::serve, this, connection);
+		}
+	}
+
+	void serve(int connection)
+	{
+		std::string request;
+		char		buffer[4096];
+
+		while (request.find("\r\n\r\n") == std::string::npos)
+		{
+			ssize_t length = recv(connection, buffer, sizeof(buffer), 0);
+
+			if (length <= 0)
+			{
+				close(connection);
+				return;
+			}
+
+			request.append(buffer, static_cast<size_t>(length));
+		}
+
+		std::string etag;
+		{
+			std::lock_guard<std::mutex> lock(this->m_mutex);
+			etag = this->m_etag;
+		}
+
+		bool		head  = request.starts_with("HEAD ");
+		uint64_t	begin = 0;
+		uint64_t	end	  = this->m_payload.size() - 1;
+		std::string status;
+		std::string headers;
+
+		auto range = request.find("Range: bytes=");
+		if (range != std::string::npos)
+		{
+			std::sscanf(request.c_str() + range, "Range: bytes=%" SCNu64 "-%" SCNu64, &begin, &end);
+			status	= "206 Partial Content";
+			headers = fmt::format("Content-Range: bytes {}-{}/{}\r\n", begin, end, this->m_payload.size());
+		}
+		else
+		{
+			status = "200 OK";
+		}
+
+		uint64_t	length	 = end - begin + 1;
+		std::string response = fmt::format("HTTP/1.1 {}\r\nContent-Length: {}\r\nAccept-Ranges: bytes\r\nETag: {}\r\nConnection: close\r\n{}\r\n",
+										   status,
+										   length,
+										   etag,
+										   headers);
+
+		if (!head)
+		{
+			uint64_t sent = this->m_truncate && range != std::string::npos ? length / 2 : length;
+			response.append(this->m_payload, begin, sent);
+			this->m_bytes_served += sent;
+		}
+
+		for (size_t offset = 0; offset < response.size();)
+		{
+			ssize_t written = send(connection, response.data() + offset, response.size() - offset, MSG_NOSIGNAL);
+
+			if (written <= 0)
+			{
+				break;
+			}
+
+			offset += static_cast<size_t>(written);
+		}
+
+		close(connection);
+	}
+
+	std::string				 m_payload;
+	std::string				 m_etag;
+	int						 m_listen_fd	= -1;
+	uint16_t				 m_port			= 0;
+	std::atomic<bool>		 m_running		= true;
+	std::atomic<bool>		 m_truncate		= false;
+	std::atomic<uint64_t>	 m_bytes_served = 0;
+	std::thread				 m_thread;
+	std::vector<std::thread> m_connections;
+	std::mutex				 m_mutex;
+};
+
+int g_failures = 0;
+
+void check(bool condition, std::string_view description)
+{
+	fmt::print("{} {}\n", condition ? "PASS" : "FAIL", description);
+	g_failures += condition ? 0 : 1;
+}
+
+std::string read_file(const fs::path& path)
+{
+	std::ifstream file(path, std::ios::binary);
+	return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+std::string make_payload(size_t size)
+{
+	std::mt19937 generator(42);
+	std::string	 payload(size, '\0');
+
+	for (auto& byte : payload)
+	{
+		byte = static_cast<char>(generator() & 0xFF);
+	}
+
+	return payload;
+}
+} // anonymous namespace
+
+int main()
+{
+	const std::string payload = make_payload(1 << 20);
+	const fs::path	  output  = fs::current_path() / "payload.bin";
+	const fs::path	  part	  = fs::current_path() / "payload.bin.part";
+
+	fs::remove(output);
+	fs::remove(part);
+
+	auto&		   network_manager = UTILS::NetworkManager::instance_ref();
+	LoopbackServer server(payload, "\"v1\"");
+
+	check(network_manager.download_file_segmented(server.get_url(), output.string(), 4), "segmented download succeeds");
+	check(read_file(output) == payload, "downloaded file matches the payload");
+	check(!fs::exists(part), "manifest is removed after a complete download");
+	check(server.take_bytes_served() == payload.size(), "every byte is requested exactly once");
+
+	fs::remove(output);
+	server.set_truncate(true);
+
+	check(!network_manager.download_file_segmented(server.get_url(), output.string(), 4), "dropped segments fail the download");
+	check(fs::exists(part), "manifest is kept after an interrupted download");
+
+	uint64_t received = server.take_bytes_served();
+	server.set_truncate(false);
+
+	check(network_manager.download_file_segmented(server.get_url(), output.string(), 4), "interrupted download resumes");
+	check(read_file(output) == payload, "resumed file matches the payload");
+	check(server.take_bytes_served() == payload.size() - received, "resume only requests the missing ranges");
+
+	fs::remove(output);
+	server.set_truncate(true);
+	network_manager.download_file_segmented(server.get_url(), output.string(), 4);
+	server.take_bytes_served();
+	server.set_truncate(false);
+	server.set_etag("\"v2\"");
+
+	check(network_manager.download_file_segmented(server.get_url(), output.string(), 4), "download with a changed ETag succeeds");
+	check(read_file(output) == payload, "file matches after the manifest was discarded");
+	check(server.take_bytes_served() == payload.size(), "a stale manifest restarts the download");
+
+	network_manager.shutdown();
+
+	return g_failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}